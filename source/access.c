@@ -0,0 +1,199 @@
+#include"access.h"
+#include<stdint.h>
+#include<string.h>
+#include"kernel.h"
+#include"memory.h"
+
+// Default access counts.
+#define DEFAULT_ACCESS_COUNT  0x4000
+
+// Maximum access count.
+#define MAX_COUNT             0xffffff
+
+// Accesses walk through a small window at the start of g_memory, so that
+// the data stays in cache and only the cost of each access is measured.
+// Window size is a power of two, and there is room past the end of the
+// window for the byte offset and the last access.
+#define WINDOW_BYTES          0x1000
+#define WINDOW_MASK           (WINDOW_BYTES - 1)
+
+// Default byte offset from an aligned address.
+#define DEFAULT_OFFSET        1
+
+// Settings.
+static int g_offset = DEFAULT_OFFSET;
+
+// Number of accesses.  For records, this is the number of records read.
+static int g_load = DEFAULT_ACCESS_COUNT;
+static int g_store = DEFAULT_ACCESS_COUNT;
+static int g_byte = DEFAULT_ACCESS_COUNT;
+static int g_half = DEFAULT_ACCESS_COUNT;
+static int g_memcpy = DEFAULT_ACCESS_COUNT;
+static int g_bytewise = DEFAULT_ACCESS_COUNT;
+static int g_record = DEFAULT_ACCESS_COUNT;
+static float g_costs[7];
+
+const BenchmarkParam kAccessParams[] =
+{
+   {"offset",   &g_offset,   0, 3,         0, NULL},
+   {"load",     &g_load,     0, MAX_COUNT, 1, g_costs + 0},
+   {"store",    &g_store,    0, MAX_COUNT, 1, g_costs + 1},
+   {"byte",     &g_byte,     0, MAX_COUNT, 1, g_costs + 2},
+   {"half",     &g_half,     0, MAX_COUNT, 1, g_costs + 3},
+   {"memcpy",   &g_memcpy,   0, MAX_COUNT, 1, g_costs + 4},
+   {"bytewise", &g_bytewise, 0, MAX_COUNT, 1, g_costs + 5},
+   {"record",   &g_record,   0, MAX_COUNT, 1, g_costs + 6},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Accessing memory through a packed struct tells the compiler that the
+// address may not be aligned.  Cortex-M7 handles unaligned LDR and STR in
+// hardware without faulting, so the compiler emits the same instructions
+// as for aligned accesses, and any extra cost comes from the bus.
+typedef struct __attribute__((packed))
+{
+   uint32_t value;
+} Unaligned32;
+
+typedef struct __attribute__((packed))
+{
+   uint16_t value;
+} Unaligned16;
+
+// Packed record with unaligned fields, similar to headers found in file
+// formats.
+typedef struct __attribute__((packed))
+{
+   uint8_t tag;
+   uint32_t value;
+   uint16_t length;
+} Record;
+
+#define RECORDS_PER_WINDOW    (WINDOW_BYTES / (int)sizeof(Record))
+
+// Read result, declared volatile to disable compiler optimizations around
+// it.
+static volatile uint32_t g_result = 0;
+
+// Return start of window, shifted by the selected offset.
+static inline volatile uint8_t *GetWindow(void)
+{
+   return (volatile uint8_t *)g_memory + g_offset;
+}
+
+// Word loads and stores at the selected offset.  Offset 0 is aligned.
+static void Load(int count)
+{
+   volatile uint8_t *window = GetWindow();
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      sum += ((volatile Unaligned32 *)
+              (window + ((i * 4) & WINDOW_MASK)))->value;
+   }
+   g_result = sum;
+}
+
+static void Store(int count)
+{
+   volatile uint8_t *window = GetWindow();
+   for(int i = 0; i < count; i++)
+      ((volatile Unaligned32 *)(window + ((i * 4) & WINDOW_MASK)))->value = i;
+}
+
+// Sequential byte loads, as used by code that works on 1-bit images one
+// byte at a time.  Alignment does not apply.
+static void Byte(int count)
+{
+   volatile uint8_t *window = GetWindow();
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+      sum += window[i & WINDOW_MASK];
+   g_result = sum;
+}
+
+// Halfword loads at the selected offset.  Odd offsets are unaligned.
+static void Half(int count)
+{
+   volatile uint8_t *window = GetWindow();
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      sum += ((volatile Unaligned16 *)
+              (window + ((i * 2) & WINDOW_MASK)))->value;
+   }
+   g_result = sum;
+}
+
+// Word loads through memcpy, which is the portable way of reading an
+// unaligned value.  Source is not volatile, so the compiler is free to
+// replace memcpy with a single load.
+static void Memcpy(int count)
+{
+   const uint8_t *window = (const uint8_t *)GetWindow();
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      uint32_t value;
+      memcpy(&value, window + ((i * 4) & WINDOW_MASK), sizeof(value));
+      sum += value;
+   }
+   g_result = sum;
+}
+
+// Little-endian word assembled from 4 byte loads, which is what parsers
+// do when they can not assume anything about alignment or byte order.
+static void Bytewise(int count)
+{
+   volatile uint8_t *window = GetWindow();
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      volatile uint8_t *p = window + ((i * 4) & WINDOW_MASK);
+      sum += (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+             ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+   }
+   g_result = sum;
+}
+
+// Read all fields of consecutive packed records.  Records are not
+// volatile, so this measures whatever the compiler generates for packed
+// struct fields.
+static void ReadRecords(int count)
+{
+   const Record *records = (const Record *)GetWindow();
+   uint32_t sum = 0;
+   int j = 0;
+   for(int i = 0; i < count; i++)
+   {
+      sum += records[j].tag + records[j].value + records[j].length;
+      if( ++j == RECORDS_PER_WINDOW )
+         j = 0;
+   }
+   g_result = sum;
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, Load, Store, Byte, Half, Memcpy, Bytewise, ReadRecords
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "access", kAccessParams, kKernels, NULL, 0, &g_state
+};
+
+// Exported functions.
+void AccessBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_memory_has_chain = 0;
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetAccessBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_ACCESS_COUNT);
+   g_offset = DEFAULT_OFFSET;
+}
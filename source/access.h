@@ -0,0 +1,16 @@
+// Benchmark for memory access at different widths and alignments, such
+// as unaligned words in packed file formats and bytes in 1-bit images.
+
+#ifndef ACCESS_H_
+#define ACCESS_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void AccessBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetAccessBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kAccessParams[];
+
+#endif  // ACCESS_H_
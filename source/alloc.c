@@ -0,0 +1,261 @@
+#include"alloc.h"
+#include<stdint.h>
+#include"allocator.h"
+#include"kernel.h"
+
+// Default allocation counts.
+#define DEFAULT_ALLOC_COUNT  0x400
+
+// Maximum allocation count.
+#define MAX_COUNT            0xfffff
+
+// Block sizes are random between 1 and 2**max_size_log2 bytes.
+#define MIN_SIZE_LOG2        4
+#define MAX_SIZE_LOG2        10
+#define DEFAULT_SIZE_LOG2    7
+
+// Number of temporaries allocated before all of them are freed.
+#define BATCH_SIZE           256
+
+// Number of live objects for churn kernels.
+#define LIVE_SLOTS           512
+
+// Settings.
+static int g_max_size_log2 = DEFAULT_SIZE_LOG2;
+
+// Number of allocations, each followed by a free at some point.
+static int g_sys_temp = DEFAULT_ALLOC_COUNT;
+static int g_arena_temp = DEFAULT_ALLOC_COUNT;
+static int g_pool_temp = DEFAULT_ALLOC_COUNT;
+static int g_sys_churn = DEFAULT_ALLOC_COUNT;
+static int g_pool_churn = DEFAULT_ALLOC_COUNT;
+static int g_format = DEFAULT_ALLOC_COUNT;
+static float g_costs[6];
+
+const BenchmarkParam kAllocParams[] =
+{
+   {"max_size_log2", &g_max_size_log2,
+    MIN_SIZE_LOG2, MAX_SIZE_LOG2, 0, NULL},
+   {"sys_temp",      &g_sys_temp,     0, MAX_COUNT, 1, g_costs + 0},
+   {"arena_temp",    &g_arena_temp,   0, MAX_COUNT, 1, g_costs + 1},
+   {"pool_temp",     &g_pool_temp,    0, MAX_COUNT, 1, g_costs + 2},
+   {"sys_churn",     &g_sys_churn,    0, MAX_COUNT, 1, g_costs + 3},
+   {"pool_churn",    &g_pool_churn,   0, MAX_COUNT, 1, g_costs + 4},
+   {"format",        &g_format,       0, MAX_COUNT, 1, g_costs + 5},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Fragmentation of churn kernels in percent, in the same order as
+// params.  Other kernels are set to -1 so that they show their cycle
+// counts instead.
+static float g_fragmentation[7] = {-1, -1, -1, -1, -1, -1, -1};
+#define SYS_CHURN_INDEX   4
+#define POOL_CHURN_INDEX  5
+
+// Live objects for churn kernels.
+typedef struct
+{
+   void *block;
+   int size;
+} Slot;
+
+static Slot g_sys_slots[LIVE_SLOTS];
+static Slot g_pool_slots[LIVE_SLOTS];
+
+// Allocators.  Arena is sized to hold one batch of the largest blocks.
+static Arena g_arena;
+static Pool g_temp_pool;
+static Pool g_churn_pool;
+static int g_initialized = 0;
+
+// API handle for kernels that use the system allocator.
+static PlaydateAPI *g_pd = NULL;
+
+// Random seed.
+static uint32_t g_seed = 1;
+
+// Return a random block size.
+static inline int RandomSize(void)
+{
+   g_seed = g_seed * 1664525u + 1013904223u;
+   return (int)((g_seed >> 16) & ((1u << g_max_size_log2) - 1)) + 1;
+}
+
+// Return a random slot index for churn kernels.
+static inline int RandomSlot(void)
+{
+   g_seed = g_seed * 1664525u + 1013904223u;
+   return (int)((g_seed >> 16) & (LIVE_SLOTS - 1));
+}
+
+// Per-frame temporaries: allocate a batch of blocks of random sizes, then
+// free all of them.
+static void SysTemp(int count)
+{
+   void *blocks[BATCH_SIZE];
+   for(int i = 0; i < count; i += BATCH_SIZE)
+   {
+      const int n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+      for(int j = 0; j < n; j++)
+         blocks[j] = g_pd->system->realloc(NULL, RandomSize());
+      for(int j = 0; j < n; j++)
+         g_pd->system->realloc(blocks[j], 0);
+   }
+}
+
+static void ArenaTemp(int count)
+{
+   for(int i = 0; i < count; i += BATCH_SIZE)
+   {
+      const int n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+      for(int j = 0; j < n; j++)
+         ArenaAlloc(&g_arena, RandomSize());
+      ResetArena(&g_arena);
+   }
+}
+
+static void PoolTemp(int count)
+{
+   void *blocks[BATCH_SIZE];
+   int sizes[BATCH_SIZE];
+   for(int i = 0; i < count; i += BATCH_SIZE)
+   {
+      const int n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+      for(int j = 0; j < n; j++)
+      {
+         sizes[j] = RandomSize();
+         blocks[j] = PoolAlloc(&g_temp_pool, sizes[j]);
+      }
+      for(int j = 0; j < n; j++)
+         PoolFree(&g_temp_pool, blocks[j], sizes[j]);
+   }
+}
+
+// Long-lived objects: replace a random live object with a new one of a
+// different size.  Over time, this fragments the system heap.
+static void SysChurn(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      Slot *slot = g_sys_slots + RandomSlot();
+      g_pd->system->realloc(slot->block, 0);
+      slot->size = RandomSize();
+      slot->block = g_pd->system->realloc(NULL, slot->size);
+   }
+}
+
+static void PoolChurn(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      Slot *slot = g_pool_slots + RandomSlot();
+      PoolFree(&g_churn_pool, slot->block, slot->size);
+      slot->size = RandomSize();
+      slot->block = PoolAlloc(&g_churn_pool, slot->size);
+   }
+}
+
+// Format a short string and free it, which is what each DrawStatus
+// function does for every line of text.
+static void Format(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      char *text = NULL;
+      g_pd->system->formatString(&text, "%d", i);
+      g_pd->system->realloc(text, 0);
+   }
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, SysTemp, ArenaTemp, PoolTemp, SysChurn, PoolChurn, Format
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "alloc", kAllocParams, kKernels, g_fragmentation, 0, &g_state,
+   "frag %.0f%%"
+};
+
+// Update fragmentation of system allocator, estimated as the fraction of
+// the address range spanned by live objects that is not used by them.
+static void UpdateSysFragmentation(void)
+{
+   uintptr_t start = UINTPTR_MAX;
+   uintptr_t end = 0;
+   size_t live = 0;
+   for(int i = 0; i < LIVE_SLOTS; i++)
+   {
+      const Slot *slot = g_sys_slots + i;
+      if( slot->block == NULL )
+         continue;
+      const uintptr_t p = (uintptr_t)slot->block;
+      if( start > p ) { start = p; }
+      if( end < p + slot->size ) { end = p + slot->size; }
+      live += slot->size;
+   }
+   g_fragmentation[SYS_CHURN_INDEX] =
+      live > 0 ? 100.0f * (1.0f - (float)live / (end - start)) : -1;
+}
+
+// Update fragmentation of churn pool, which is the fraction of pages
+// that is not used by live objects.
+static void UpdatePoolFragmentation(void)
+{
+   size_t live = 0;
+   for(int i = 0; i < LIVE_SLOTS; i++)
+   {
+      if( g_pool_slots[i].block != NULL )
+         live += g_pool_slots[i].size;
+   }
+   g_fragmentation[POOL_CHURN_INDEX] =
+      g_churn_pool.reserved > 0
+      ? 100.0f * (1.0f - (float)live / g_churn_pool.reserved) : -1;
+}
+
+// Free all live objects.
+static void FreeSlots(void)
+{
+   for(int i = 0; i < LIVE_SLOTS; i++)
+   {
+      if( g_sys_slots[i].block != NULL )
+         g_pd->system->realloc(g_sys_slots[i].block, 0);
+      g_sys_slots[i].block = NULL;
+      g_pool_slots[i].block = NULL;
+   }
+   FreePool(&g_churn_pool);
+}
+
+// Exported functions.
+void AllocBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_pd = pd;
+   if( g_initialized == 0 )
+   {
+      if( InitArena(&g_arena, pd, BATCH_SIZE << MAX_SIZE_LOG2) == 0 )
+         pd->system->logToConsole("alloc: out of memory for arena");
+      InitPool(&g_temp_pool, pd);
+      InitPool(&g_churn_pool, pd);
+      g_initialized = 1;
+   }
+
+   // Fragmentation is measured before KernelBenchmark draws it, so the
+   // displayed values match the live objects left by the previous frame.
+   UpdateSysFragmentation();
+   UpdatePoolFragmentation();
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetAllocBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_ALLOC_COUNT);
+   g_max_size_log2 = DEFAULT_SIZE_LOG2;
+   g_seed = 1;
+   if( g_initialized != 0 )
+      FreeSlots();
+   g_fragmentation[SYS_CHURN_INDEX] = -1;
+   g_fragmentation[POOL_CHURN_INDEX] = -1;
+}
@@ -0,0 +1,16 @@
+// Benchmark for memory allocation patterns, comparing the system allocator
+// with the arena and pool allocators from allocator.h.
+
+#ifndef ALLOC_H_
+#define ALLOC_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void AllocBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetAllocBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kAllocParams[];
+
+#endif  // ALLOC_H_
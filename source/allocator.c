@@ -0,0 +1,130 @@
+#include"allocator.h"
+
+// Free blocks and pages are linked through their first word.
+struct PoolBlock
+{
+   PoolBlock *next;
+};
+
+// Round up size to multiple of alignment.
+static size_t AlignSize(size_t size)
+{
+   return (size + ALLOCATOR_ALIGNMENT - 1) &
+          ~(size_t)(ALLOCATOR_ALIGNMENT - 1);
+}
+
+// Return size class index for a block size, or -1 if block is too large.
+static int GetSizeClass(size_t size)
+{
+   if( size <= ((size_t)1 << POOL_MIN_CLASS_LOG2) )
+      return 0;
+   if( size > ((size_t)1 << POOL_MAX_CLASS_LOG2) )
+      return -1;
+
+   // Number of bits needed for size - 1 is log2 of the rounded up size.
+   return 32 - __builtin_clz((unsigned int)(size - 1)) - POOL_MIN_CLASS_LOG2;
+}
+
+// Allocate a new page and split it into blocks for a size class.
+static int AddPage(Pool *pool, int size_class)
+{
+   PoolBlock *page = pool->pd->system->realloc(NULL, POOL_PAGE_SIZE);
+   if( page == NULL )
+      return 0;
+   page->next = pool->pages;
+   pool->pages = page;
+   pool->reserved += POOL_PAGE_SIZE;
+
+   // First block of each page is used for linking pages together, which
+   // saves a separate header.  This costs 0.4% of the page for 16 byte
+   // blocks, but 25% for 1024 byte blocks.
+   const size_t block_size = (size_t)1 << (size_class + POOL_MIN_CLASS_LOG2);
+   char *start = (char*)page + block_size;
+   char *end = (char*)page + POOL_PAGE_SIZE;
+   for(char *p = start; p + block_size <= end; p += block_size)
+   {
+      PoolBlock *block = (PoolBlock*)p;
+      block->next = pool->free_blocks[size_class];
+      pool->free_blocks[size_class] = block;
+   }
+   return 1;
+}
+
+// Exported functions.
+int InitArena(Arena *arena, PlaydateAPI *pd, size_t size)
+{
+   arena->pd = pd;
+   arena->base = pd->system->realloc(NULL, size);
+   arena->size = arena->base != NULL ? size : 0;
+   arena->used = 0;
+   return arena->base != NULL;
+}
+
+void FreeArena(Arena *arena)
+{
+   if( arena->base != NULL )
+      arena->pd->system->realloc(arena->base, 0);
+   arena->base = NULL;
+   arena->size = arena->used = 0;
+}
+
+void *ArenaAlloc(Arena *arena, size_t size)
+{
+   size = AlignSize(size);
+   if( size > arena->size - arena->used )
+      return NULL;
+   void *block = arena->base + arena->used;
+   arena->used += size;
+   return block;
+}
+
+void InitPool(Pool *pool, PlaydateAPI *pd)
+{
+   pool->pd = pd;
+   for(int i = 0; i < POOL_CLASS_COUNT; i++)
+      pool->free_blocks[i] = NULL;
+   pool->pages = NULL;
+   pool->reserved = 0;
+}
+
+void FreePool(Pool *pool)
+{
+   while( pool->pages != NULL )
+   {
+      PoolBlock *next = pool->pages->next;
+      pool->pd->system->realloc(pool->pages, 0);
+      pool->pages = next;
+   }
+   InitPool(pool, pool->pd);
+}
+
+void *PoolAlloc(Pool *pool, size_t size)
+{
+   const int size_class = GetSizeClass(size);
+   if( size_class < 0 )
+      return pool->pd->system->realloc(NULL, size);
+
+   if( pool->free_blocks[size_class] == NULL &&
+       AddPage(pool, size_class) == 0 )
+   {
+      return NULL;
+   }
+   PoolBlock *block = pool->free_blocks[size_class];
+   pool->free_blocks[size_class] = block->next;
+   return block;
+}
+
+void PoolFree(Pool *pool, void *block, size_t size)
+{
+   if( block == NULL )
+      return;
+   const int size_class = GetSizeClass(size);
+   if( size_class < 0 )
+   {
+      pool->pd->system->realloc(block, 0);
+      return;
+   }
+   PoolBlock *b = block;
+   b->next = pool->free_blocks[size_class];
+   pool->free_blocks[size_class] = b;
+}
@@ -0,0 +1,89 @@
+// Alternatives to the system allocator for short-lived and fixed-size
+// objects.
+//
+// Arena is a bump allocator: allocation advances a pointer, and all
+// allocations are released at once by resetting the arena.  This suits
+// per-frame temporaries.
+//
+// Pool keeps a free list for each power of two size class, and carves
+// new blocks out of pages allocated from the system allocator.  Blocks
+// are returned to their free lists but pages are never released until
+// the whole pool is freed, so this suits objects that are allocated and
+// freed repeatedly with similar sizes.
+//
+// Pool does not store a header for each block, so callers pass the size
+// of each block to PoolFree.  This is usually known from the object type.
+
+#ifndef ALLOCATOR_H_
+#define ALLOCATOR_H_
+
+#include<stddef.h>
+#include"pd_api.h"
+
+// Alignment of all returned blocks.
+#define ALLOCATOR_ALIGNMENT  8
+
+typedef struct
+{
+   PlaydateAPI *pd;
+   char *base;
+   size_t size;
+   size_t used;
+} Arena;
+
+// Allocate "size" bytes for arena.  Returns 0 on failure.
+int InitArena(Arena *arena, PlaydateAPI *pd, size_t size);
+
+// Release memory held by arena.
+void FreeArena(Arena *arena);
+
+// Allocate a block from arena, returns NULL if arena is full.
+void *ArenaAlloc(Arena *arena, size_t size);
+
+// Release all blocks allocated from arena.
+static inline void ResetArena(Arena *arena)
+{
+   arena->used = 0;
+}
+
+// Size classes are powers of two from 16 to 1024 bytes.  Larger blocks
+// go to the system allocator.
+#define POOL_MIN_CLASS_LOG2  4
+#define POOL_MAX_CLASS_LOG2  10
+#define POOL_CLASS_COUNT     (POOL_MAX_CLASS_LOG2 - POOL_MIN_CLASS_LOG2 + 1)
+
+// Bytes allocated from the system allocator each time a size class runs
+// out of free blocks.
+#define POOL_PAGE_SIZE       4096
+
+typedef struct PoolBlock PoolBlock;
+
+typedef struct
+{
+   PlaydateAPI *pd;
+
+   // Free list for each size class.
+   PoolBlock *free_blocks[POOL_CLASS_COUNT];
+
+   // List of pages allocated from the system allocator.
+   PoolBlock *pages;
+
+   // Total bytes held in pages.
+   size_t reserved;
+} Pool;
+
+// Initialize an empty pool.  Pages are allocated on demand.
+void InitPool(Pool *pool, PlaydateAPI *pd);
+
+// Release all pages held by pool.  Blocks allocated from the pool must
+// not be used after this.
+void FreePool(Pool *pool);
+
+// Allocate a block of at least "size" bytes, returns NULL on failure.
+void *PoolAlloc(Pool *pool, size_t size);
+
+// Return a block to the pool.  "size" must be the same size that was
+// passed to PoolAlloc.
+void PoolFree(Pool *pool, void *block, size_t size);
+
+#endif  // ALLOCATOR_H_
@@ -1,4 +1,5 @@
 #include"arith.h"
+#include"timer.h"
 
 // Default operation counts.
 //
@@ -11,30 +12,83 @@
 // that requires shipping extra fonts.
 #define DEFAULT_OPERATION_COUNT  0x8000
 
+// Number of iterations for measuring loop overhead.
+#define CALIBRATION_COUNT        0x8000
+
 // Operation counts.
 static int g_int_add = DEFAULT_OPERATION_COUNT;
 static int g_int_mul = DEFAULT_OPERATION_COUNT;
 static int g_float_add = DEFAULT_OPERATION_COUNT;
 static int g_float_mul = DEFAULT_OPERATION_COUNT;
 
+// Measured cycles per operation.
+static float g_int_add_cost = 0;
+static float g_int_mul_cost = 0;
+static float g_float_add_cost = 0;
+static float g_float_mul_cost = 0;
+
+// Measured cycles per iteration of a loop that does nothing but load and
+// store a volatile variable.  This overhead is included in each of the
+// costs above, and is subtracted to get the cost of the operation itself.
+static float g_overhead_cost = 0;
+
+const BenchmarkParam kArithmeticParams[] =
+{
+   {"int_add",   &g_int_add,   0, 0xffffff, 1, &g_int_add_cost},
+   {"int_mul",   &g_int_mul,   0, 0xffffff, 1, &g_int_mul_cost},
+   {"float_add", &g_float_add, 0, 0xffffff, 1, &g_float_add_cost},
+   {"float_mul", &g_float_mul, 0, 0xffffff, 1, &g_float_mul_cost},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
 // Run computations.
 // https://gcc.godbolt.org/z/sb8sjhde3
-static void RunBenchmark(void)
+static void RunBenchmark(PlaydateAPI *pd)
 {
    // Intermediate results.  These are declared volatile to disable
    // compiler optimizations around them.
    volatile int int_result = 0;
    volatile float float_result = 0;
 
+   // Each loop is timed separately, so that the costs are not mixed with
+   // drawing and display updates.
+   //
+   // First loop measures overhead, see g_overhead_cost.
+   uint32_t t0 = GetTimestamp(pd);
+   for(int i = 0; i < CALIBRATION_COUNT; i++)
+      int_result = int_result;
+   uint32_t t1 = GetTimestamp(pd);
+   UpdateCost(&g_overhead_cost, t1 - t0, CALIBRATION_COUNT);
+
+   t0 = GetTimestamp(pd);
    for(int i = 0; i < g_int_add; i++)
       int_result += i;
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_int_add_cost, t1 - t0, g_int_add);
+
+   t0 = GetTimestamp(pd);
    for(int i = 0; i < g_int_mul; i++)
       int_result *= i;
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_int_mul_cost, t1 - t0, g_int_mul);
 
+   t0 = GetTimestamp(pd);
    for(int i = 0; i < g_float_add; i++)
       float_result += i;
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_float_add_cost, t1 - t0, g_float_add);
+
+   t0 = GetTimestamp(pd);
    for(int i = 0; i < g_float_mul; i++)
       float_result *= i;
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_float_mul_cost, t1 - t0, g_float_mul);
+}
+
+// Return cost in nanoseconds with loop overhead subtracted.
+static float NetNanoseconds(float cycles)
+{
+   return CyclesToNanoseconds(SubtractOverhead(cycles, g_overhead_cost));
 }
 
 // Draw frame rate and help text.
@@ -46,25 +100,57 @@ static void DrawStatus(PlaydateAPI *pd, int full_refresh)
    int length;
    if( full_refresh != 0 )
    {
-      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 185, kColorWhite);
+      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 225, kColorWhite);
       length = pd->system->formatString(
          &text,
-         "FPS = %.1f\n"
+         "FPS = %.1f, overhead = %.2f ns\n"
          "int: add = %d, mul = %d\n"
-         "float: add = %d, mul = %d\n\n"
+         "float: add = %d, mul = %d\n"
+         "ns/op: %.2f, %.2f, %.2f, %.2f\n"
+         "cycles/op: %.2f, %.2f, %.2f, %.2f\n"
+         "net ns/op: %.2f, %.2f, %.2f, %.2f\n"
          /* Left */  "\u2b05 + crank: adjust integer additions\n"
          /* Up */    "\u2b06 + crank: adjust integer multiplications\n"
          /* Right */ "\u27a1 + crank: adjust floating point additions\n"
          /* Down */  "\u2b07 + crank: adjust floating point multiplications\n"
          /* A */     "\u24b6 + crank: adjust everything at once",
-         (double)fps,
+         (double)fps, (double)CyclesToNanoseconds(g_overhead_cost),
          g_int_add, g_int_mul,
-         g_float_add, g_float_mul);
+         g_float_add, g_float_mul,
+         (double)CyclesToNanoseconds(g_int_add_cost),
+         (double)CyclesToNanoseconds(g_int_mul_cost),
+         (double)CyclesToNanoseconds(g_float_add_cost),
+         (double)CyclesToNanoseconds(g_float_mul_cost),
+         (double)g_int_add_cost, (double)g_int_mul_cost,
+         (double)g_float_add_cost, (double)g_float_mul_cost,
+         (double)NetNanoseconds(g_int_add_cost),
+         (double)NetNanoseconds(g_int_mul_cost),
+         (double)NetNanoseconds(g_float_add_cost),
+         (double)NetNanoseconds(g_float_mul_cost));
    }
    else
    {
-      pd->graphics->fillRect(0, 0, 128, 25, kColorWhite);
-      length = pd->system->formatString(&text, "FPS = %.1f", (double)fps);
+      // Frame rate and measured costs are updated every frame, the
+      // parameter lines in between are left as is.
+      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 25, kColorWhite);
+      pd->graphics->fillRect(0, 65, LCD_COLUMNS, 60, kColorWhite);
+      length = pd->system->formatString(
+         &text,
+         "FPS = %.1f, overhead = %.2f ns\n\n\n"
+         "ns/op: %.2f, %.2f, %.2f, %.2f\n"
+         "cycles/op: %.2f, %.2f, %.2f, %.2f\n"
+         "net ns/op: %.2f, %.2f, %.2f, %.2f",
+         (double)fps, (double)CyclesToNanoseconds(g_overhead_cost),
+         (double)CyclesToNanoseconds(g_int_add_cost),
+         (double)CyclesToNanoseconds(g_int_mul_cost),
+         (double)CyclesToNanoseconds(g_float_add_cost),
+         (double)CyclesToNanoseconds(g_float_mul_cost),
+         (double)g_int_add_cost, (double)g_int_mul_cost,
+         (double)g_float_add_cost, (double)g_float_mul_cost,
+         (double)NetNanoseconds(g_int_add_cost),
+         (double)NetNanoseconds(g_int_mul_cost),
+         (double)NetNanoseconds(g_float_add_cost),
+         (double)NetNanoseconds(g_float_mul_cost));
    }
    pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
    pd->system->realloc(text, 0);
@@ -83,29 +169,29 @@ static void HandleInput(PlaydateAPI *pd, PDButtons buttons)
 {
    if( (buttons & (kButtonA | kButtonB)) != 0 )
    {
-      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 205, LCD_COLUMNS, 20, kColorXOR);
       buttons |= kButtonLeft | kButtonRight | kButtonUp | kButtonDown;
    }
    const int delta = 100 * pd->system->getCrankChange();
 
    if( (buttons & kButtonLeft) != 0 )
    {
-      pd->graphics->fillRect(0, 85, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_int_add, delta);
    }
    if( (buttons & kButtonUp) != 0 )
    {
-      pd->graphics->fillRect(0, 105, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_int_mul, delta);
    }
    if( (buttons & kButtonRight) != 0 )
    {
-      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_float_add, delta);
    }
    if( (buttons & kButtonDown) != 0 )
    {
-      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 185, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_float_mul, delta);
    }
 }
@@ -116,11 +202,11 @@ void ArithmeticBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
    if( buttons != 0 )
       full_refresh = 1;
 
-   RunBenchmark();
+   RunBenchmark(pd);
    DrawStatus(pd, full_refresh);
    HandleInput(pd, buttons);
 
-   pd->graphics->markUpdatedRows(5, full_refresh != 0 ? 184 : 24);
+   pd->graphics->markUpdatedRows(5, full_refresh != 0 ? 224 : 124);
 }
 
 void ResetArithmeticBenchmark(void)
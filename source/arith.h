@@ -4,8 +4,12 @@
 #define ARITH_H_
 
 #include"pd_api.h"
+#include"param.h"
 
 void ArithmeticBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
 void ResetArithmeticBenchmark(void);
 
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kArithmeticParams[];
+
 #endif  // ARITH_H_
@@ -0,0 +1,163 @@
+#include"bandwidth.h"
+#include<string.h>
+#include"kernel.h"
+#include"memory.h"
+
+// Default byte counts.
+#define DEFAULT_BYTE_COUNT   0x10000
+
+// Default access width, as log2 of number of bytes.
+#define DEFAULT_WIDTH_LOG2   2
+
+// Size of each array.  g_memory is split into three arrays of this size.
+#define ARRAY_WORDS          (MAX_WORD_COUNT / 4)
+#define MAX_BYTE_COUNT       (ARRAY_WORDS * 4)
+
+// Number of bytes written by each kernel.
+static int g_copy = DEFAULT_BYTE_COUNT;
+static int g_scale = DEFAULT_BYTE_COUNT;
+static int g_add = DEFAULT_BYTE_COUNT;
+static int g_triad = DEFAULT_BYTE_COUNT;
+static int g_memcpy = DEFAULT_BYTE_COUNT;
+static int g_memset = DEFAULT_BYTE_COUNT;
+static float g_costs[6];
+
+// Access width: 0 = byte, 1 = halfword, 2 = word, 3 = doubleword
+// (LDRD/STRD), 4 = 4 words.
+static int g_width_log2 = DEFAULT_WIDTH_LOG2;
+
+const BenchmarkParam kBandwidthParams[] =
+{
+   {"width_log2", &g_width_log2, 0, 4,              0, NULL},
+   {"copy",       &g_copy,       0, MAX_BYTE_COUNT, 1, g_costs + 0},
+   {"scale",      &g_scale,      0, MAX_BYTE_COUNT, 1, g_costs + 1},
+   {"add",        &g_add,        0, MAX_BYTE_COUNT, 1, g_costs + 2},
+   {"triad",      &g_triad,      0, MAX_BYTE_COUNT, 1, g_costs + 3},
+   {"memcpy",     &g_memcpy,     0, MAX_BYTE_COUNT, 1, g_costs + 4},
+   {"memset",     &g_memset,     0, MAX_BYTE_COUNT, 1, g_costs + 5},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Scale factor, declared volatile so that the compiler can not fold it
+// into the operations.
+static volatile int g_factor = 3;
+
+// Operations on arrays a, b, and c, with scale factor k.
+#define COPY_OP(i)   b[i] = a[i]
+#define SCALE_OP(i)  b[i] = k * c[i]
+#define ADD_OP(i)    c[i] = a[i] + b[i]
+#define TRIAD_OP(i)  a[i] = b[i] + k * c[i]
+
+// Apply operation to "count" bytes, one element at a time.  Arrays are
+// volatile so that each access is exactly the selected width.  Not all
+// operations use all arrays, hence the void casts.
+#define STREAM_LOOP(type, count, OP) \
+   do \
+   { \
+      volatile type *a = (volatile type *)g_memory; \
+      volatile type *b = (volatile type *)(g_memory + ARRAY_WORDS); \
+      volatile type *c = (volatile type *)(g_memory + 2 * ARRAY_WORDS); \
+      const type k = (type)g_factor; \
+      const int n = (count) / (int)sizeof(type); \
+      (void)a; (void)b; (void)c; (void)k; \
+      for(int i = 0; i < n; i++) \
+      { \
+         OP(i); \
+      } \
+   } while(0)
+
+// Apply operation to "count" bytes, 4 words at a time.
+#define STREAM_BURST(count, OP) \
+   do \
+   { \
+      volatile uint32_t *a = (volatile uint32_t *)g_memory; \
+      volatile uint32_t *b = (volatile uint32_t *)(g_memory + ARRAY_WORDS); \
+      volatile uint32_t *c = \
+         (volatile uint32_t *)(g_memory + 2 * ARRAY_WORDS); \
+      const uint32_t k = (uint32_t)g_factor; \
+      const int n = (count) / 16 * 4; \
+      (void)a; (void)b; (void)c; (void)k; \
+      for(int i = 0; i < n; i += 4) \
+      { \
+         OP(i); OP(i + 1); OP(i + 2); OP(i + 3); \
+      } \
+   } while(0)
+
+// Define a kernel that applies an operation at the selected width.
+#define DEFINE_KERNEL(name, OP) \
+   static void name(int count) \
+   { \
+      switch( g_width_log2 ) \
+      { \
+         case 0:  STREAM_LOOP(uint8_t, count, OP);  break; \
+         case 1:  STREAM_LOOP(uint16_t, count, OP); break; \
+         case 2:  STREAM_LOOP(uint32_t, count, OP); break; \
+         case 3:  STREAM_LOOP(uint64_t, count, OP); break; \
+         default: STREAM_BURST(count, OP);          break; \
+      } \
+   }
+
+DEFINE_KERNEL(CopyElements, COPY_OP)
+DEFINE_KERNEL(Scale, SCALE_OP)
+DEFINE_KERNEL(Add, ADD_OP)
+DEFINE_KERNEL(Triad, TRIAD_OP)
+
+// Copy with the selected width.  For 4-word width, the device build uses
+// LDM/STM, which the compiler would not generate for volatile accesses.
+static void Copy(int count)
+{
+#if defined(__arm__)
+   if( g_width_log2 >= 4 )
+   {
+      const int *src = (const int *)g_memory;
+      int *dst = (int *)(g_memory + ARRAY_WORDS);
+      for(int i = count / 16; i > 0; i--)
+      {
+         __asm__ volatile(
+            "ldmia %0!, {r2, r3, r4, r5}\n\t"
+            "stmia %1!, {r2, r3, r4, r5}"
+            : "+r"(src), "+r"(dst)
+            :
+            : "r2", "r3", "r4", "r5", "memory");
+      }
+      return;
+   }
+#endif
+   CopyElements(count);
+}
+
+// Library functions, which are independent of the selected width.
+static void Memcpy(int count)
+{
+   memcpy((void *)(g_memory + ARRAY_WORDS), (const void *)g_memory, count);
+}
+
+static void Memset(int count)
+{
+   memset((void *)(g_memory + ARRAY_WORDS), g_factor, count);
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, Copy, Scale, Add, Triad, Memcpy, Memset
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "bandwidth", kBandwidthParams, kKernels, NULL, 1, &g_state
+};
+
+// Exported functions.
+void BandwidthBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_memory_has_chain = 0;
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetBandwidthBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_BYTE_COUNT);
+   g_width_log2 = DEFAULT_WIDTH_LOG2;
+}
@@ -0,0 +1,16 @@
+// Benchmark for memory bandwidth, with STREAM-style kernels at different
+// access widths.
+
+#ifndef BANDWIDTH_H_
+#define BANDWIDTH_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void BandwidthBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetBandwidthBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kBandwidthParams[];
+
+#endif  // BANDWIDTH_H_
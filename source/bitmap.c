@@ -0,0 +1,228 @@
+#include"bitmap.h"
+#include<stdint.h>
+#include"kernel.h"
+
+// Default call count.
+#define DEFAULT_CALL_COUNT  100
+
+// Maximum call count.
+#define MAX_COUNT           10000
+
+// Bitmap size range.
+#define MAX_SIZE            128
+#define DEFAULT_SIZE        16
+
+// Scale is in units of 1/4, and angle is in units of 15 degrees.
+#define SCALE_UNIT          4
+#define MAX_SCALE           (4 * SCALE_UNIT)
+#define ANGLE_UNIT          15
+#define ANGLE_STEPS         (360 / ANGLE_UNIT)
+
+// Number of random positions that calls cycle through, must be a power
+// of two.
+#define POSITION_COUNT      256
+
+// Stencil is a tiled checkerboard.  Tiled stencils must have a width that
+// is a multiple of 32.
+#define STENCIL_SIZE        32
+
+// Settings.
+static int g_size = DEFAULT_SIZE;
+static int g_mode = kDrawModeCopy;
+static int g_flip = kBitmapUnflipped;
+static int g_scale = SCALE_UNIT;
+static int g_angle = 0;
+static int g_mask = 0;
+static int g_stencil = 0;
+
+// Number of bitmaps drawn.
+static int g_draw = DEFAULT_CALL_COUNT;
+static float g_cost;
+
+const BenchmarkParam kBitmapParams[] =
+{
+   {"size",       &g_size,    1, MAX_SIZE,          0, NULL},
+   {"mode",       &g_mode,    0, kDrawModeInverted, 0, NULL},
+   {"flip",       &g_flip,    0, kBitmapFlippedXY,  0, NULL},
+   {"scale_x4",   &g_scale,   1, MAX_SCALE,         0, NULL},
+   {"angle_step", &g_angle,   0, ANGLE_STEPS - 1,   0, NULL},
+   {"mask",       &g_mask,    0, 1,                 0, NULL},
+   {"stencil",    &g_stencil, 0, 1,                 0, NULL},
+   {"draw",       &g_draw,    0, MAX_COUNT,         1, &g_cost},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Center of each bitmap drawn.
+typedef struct
+{
+   int x, y;
+} Position;
+static Position g_positions[POSITION_COUNT];
+
+// Bitmap settings, lazily updated on change.
+static LCDBitmap *g_bitmap = NULL;
+static int g_bitmap_size = 0;
+static int g_bitmap_mask = -1;
+
+// Offscreen bitmap that all calls draw to, so that drawing does not
+// interfere with status text.
+static LCDBitmap *g_target = NULL;
+
+// Stencil tile.
+static LCDBitmap *g_stencil_bitmap = NULL;
+
+// API handle for kernels that call the SDK.
+static PlaydateAPI *g_pd = NULL;
+
+// Random seed for positions and bitmap pixels.
+static uint32_t g_seed = 1;
+
+// Return a random number in the range [0, limit).
+static int Random(int limit)
+{
+   g_seed = g_seed * 1664525u + 1013904223u;
+   return (int)(((g_seed >> 16) * (uint32_t)limit) >> 16);
+}
+
+// Draw bitmaps with the current settings.  Bitmaps are drawn with
+// drawRotatedBitmap if angle is nonzero, drawScaledBitmap if scale is
+// not 1, and drawBitmap otherwise.  Scaled and rotated bitmaps are
+// flipped with negative scales.
+//
+// Setting the target, draw mode and stencil is included in the cost, but
+// is only done once per frame.
+static void Draw(int count)
+{
+   PlaydateAPI *pd = g_pd;
+   pd->graphics->pushContext(g_target);
+   pd->graphics->setDrawMode(g_mode);
+   if( g_stencil != 0 )
+      pd->graphics->setStencilImage(g_stencil_bitmap, 1);
+
+   const float scale = (float)g_scale / SCALE_UNIT;
+   const float xscale =
+      g_flip == kBitmapFlippedX || g_flip == kBitmapFlippedXY ? -scale : scale;
+   const float yscale =
+      g_flip == kBitmapFlippedY || g_flip == kBitmapFlippedXY ? -scale : scale;
+   if( g_angle != 0 )
+   {
+      const float angle = (float)(g_angle * ANGLE_UNIT);
+      for(int i = 0; i < count; i++)
+      {
+         const Position *p = g_positions + (i & (POSITION_COUNT - 1));
+         pd->graphics->drawRotatedBitmap(g_bitmap, p->x, p->y, angle,
+                                         0.5f, 0.5f, xscale, yscale);
+      }
+   }
+   else if( g_scale != SCALE_UNIT )
+   {
+      const int center = g_size * g_scale / (2 * SCALE_UNIT);
+      for(int i = 0; i < count; i++)
+      {
+         const Position *p = g_positions + (i & (POSITION_COUNT - 1));
+         pd->graphics->drawScaledBitmap(g_bitmap, p->x - center,
+                                        p->y - center, xscale, yscale);
+      }
+   }
+   else
+   {
+      const int center = g_size / 2;
+      for(int i = 0; i < count; i++)
+      {
+         const Position *p = g_positions + (i & (POSITION_COUNT - 1));
+         pd->graphics->drawBitmap(g_bitmap, p->x - center, p->y - center,
+                                  g_flip);
+      }
+   }
+
+   if( g_stencil != 0 )
+      pd->graphics->setStencilImage(NULL, 0);
+   pd->graphics->popContext();
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, NULL, NULL, NULL, NULL, NULL, NULL, Draw
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "bitmap", kBitmapParams, kKernels, NULL, 0, &g_state
+};
+
+// Initialize target, stencil, and positions.
+static void Init(PlaydateAPI *pd)
+{
+   g_target = pd->graphics->newBitmap(LCD_COLUMNS, LCD_ROWS, kColorWhite);
+
+   g_stencil_bitmap =
+      pd->graphics->newBitmap(STENCIL_SIZE, STENCIL_SIZE, kColorBlack);
+   pd->graphics->pushContext(g_stencil_bitmap);
+   for(int y = 0; y < STENCIL_SIZE; y++)
+   {
+      for(int x = (y & 1); x < STENCIL_SIZE; x += 2)
+         pd->graphics->setPixel(x, y, kColorWhite);
+   }
+   pd->graphics->popContext();
+
+   g_seed = 1;
+   for(int i = 0; i < POSITION_COUNT; i++)
+   {
+      g_positions[i].x = Random(LCD_COLUMNS);
+      g_positions[i].y = Random(LCD_ROWS);
+   }
+}
+
+// Initialize or update bitmap.  Bitmap is a circle of random black and
+// white pixels.  Pixels outside the circle are transparent if mask is
+// set, and white otherwise.
+static void UpdateBitmap(PlaydateAPI *pd)
+{
+   if( g_bitmap_size == g_size && g_bitmap_mask == g_mask )
+      return;
+   g_bitmap_size = g_size;
+   g_bitmap_mask = g_mask;
+
+   if( g_bitmap != NULL )
+      pd->graphics->freeBitmap(g_bitmap);
+   g_bitmap = pd->graphics->newBitmap(
+      g_size, g_size, g_mask != 0 ? kColorClear : kColorWhite);
+   pd->graphics->pushContext(g_bitmap);
+   const int r = g_size / 2;
+   for(int y = 0; y < g_size; y++)
+   {
+      for(int x = 0; x < g_size; x++)
+      {
+         if( (x - r) * (x - r) + (y - r) * (y - r) <= r * r )
+         {
+            pd->graphics->setPixel(
+               x, y, Random(2) != 0 ? kColorWhite : kColorBlack);
+         }
+      }
+   }
+   pd->graphics->popContext();
+}
+
+// Exported functions.
+void BitmapBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_pd = pd;
+   if( g_target == NULL )
+      Init(pd);
+   UpdateBitmap(pd);
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetBitmapBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_CALL_COUNT);
+   g_size = DEFAULT_SIZE;
+   g_mode = kDrawModeCopy;
+   g_flip = kBitmapUnflipped;
+   g_scale = SCALE_UNIT;
+   g_angle = 0;
+   g_mask = 0;
+   g_stencil = 0;
+}
@@ -0,0 +1,16 @@
+// Benchmark for drawBitmap, drawScaledBitmap and drawRotatedBitmap with
+// different draw modes, flips, masks and stencils.
+
+#ifndef BITMAP_H_
+#define BITMAP_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void BitmapBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetBitmapBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kBitmapParams[];
+
+#endif  // BITMAP_H_
@@ -0,0 +1,138 @@
+#include"blit.h"
+#include<string.h>
+
+// Number of words in each frame buffer row.
+#define FRAME_WORDS  (LCD_ROWSIZE / 4)
+
+// Convert one row of bitmap bytes to words, with a zero word on each
+// side.  "valid" is the mask of pixels within the bitmap for the last
+// word, so that padding bits are cleared.
+static void ConvertRow(uint32_t *output,
+                       const uint8_t *input,
+                       int rowbytes,
+                       int words,
+                       uint32_t valid)
+{
+   output[0] = 0;
+   for(int i = 0; i < words; i++)
+   {
+      uint32_t w = 0;
+      for(int b = 0; b < 4; b++)
+      {
+         const int index = i * 4 + b;
+         w = (w << 8) | (index < rowbytes ? input[index] : 0);
+      }
+      output[i + 1] = w;
+   }
+   output[words] &= valid;
+   output[words + 1] = 0;
+}
+
+// Exported functions.
+int InitBlitImage(BlitImage *image, PlaydateAPI *pd, LCDBitmap *bitmap)
+{
+   int width, height, rowbytes;
+   uint8_t *mask, *data;
+   pd->graphics->getBitmapData(bitmap, &width, &height, &rowbytes,
+                               &mask, &data);
+
+   const int words = (width + 31) / 32;
+   image->pd = pd;
+   image->width = width;
+   image->height = height;
+   image->stride = words + 2;
+
+   // Data, mask, and coverage are allocated as a single block.
+   const size_t size = (2 * height + 1) * image->stride * sizeof(uint32_t);
+   image->data = pd->system->realloc(NULL, size);
+   if( image->data == NULL )
+   {
+      image->mask = image->coverage = NULL;
+      return 0;
+   }
+   image->mask = image->data + height * image->stride;
+   image->coverage = image->mask + height * image->stride;
+
+   const uint32_t valid = (width & 31) == 0 ? ~0u : ~(~0u >> (width & 31));
+   for(int y = 0; y < height; y++)
+   {
+      ConvertRow(image->data + y * image->stride,
+                 data + y * rowbytes, rowbytes, words, valid);
+   }
+
+   // Bitmaps without a mask are fully opaque.
+   image->coverage[0] = 0;
+   for(int i = 1; i <= words; i++)
+      image->coverage[i] = ~0u;
+   image->coverage[words] &= valid;
+   image->coverage[words + 1] = 0;
+   for(int y = 0; y < height; y++)
+   {
+      uint32_t *row = image->mask + y * image->stride;
+      if( mask != NULL )
+         ConvertRow(row, mask + y * rowbytes, rowbytes, words, valid);
+      else
+         memcpy(row, image->coverage, image->stride * sizeof(uint32_t));
+   }
+   return 1;
+}
+
+void FreeBlitImage(BlitImage *image)
+{
+   if( image->data != NULL )
+      image->pd->system->realloc(image->data, 0);
+   image->data = image->mask = image->coverage = NULL;
+}
+
+// Draw rows with a word operation.  Destination word i within the sprite
+// gets bits from source words i - 1 and i, where source word indices are
+// offset by 1 for the zero padding.  "(a << 1) << (31 - shift)" is used
+// instead of "a << (32 - shift)" so that zero shift is well defined.
+#define BLIT_ROWS(MASK_ROW, OP) \
+   for(int j = row0; j < row1; j++) \
+   { \
+      uint32_t *dst = (uint32_t *)(frame + (y + j) * LCD_ROWSIZE) + word_x; \
+      const uint32_t *src = image->data + j * image->stride; \
+      const uint32_t *msk = (MASK_ROW); \
+      for(int i = col0; i < col1; i++) \
+      { \
+         const uint32_t s = ((src[i] << 1) << (31 - shift)) | \
+                            (src[i + 1] >> shift); \
+         const uint32_t m = ((msk[i] << 1) << (31 - shift)) | \
+                            (msk[i + 1] >> shift); \
+         const uint32_t d = LoadPixels(dst + i); \
+         StorePixels(dst + i, (OP)); \
+      } \
+   }
+
+void Blit(uint8_t *frame, const BlitImage *image, int x, int y, BlitMode mode)
+{
+   // Clip rows.
+   const int row0 = y < 0 ? -y : 0;
+   const int row1 =
+      y + image->height > LCD_ROWS ? LCD_ROWS - y : image->height;
+
+   // Clip columns, in units of words.  An extra word is needed when the
+   // image is not aligned, to hold bits shifted out of the last word.
+   const int word_x = x >> 5;
+   const int shift = x & 31;
+   const int words = image->stride - 2 + (shift != 0 ? 1 : 0);
+   const int col0 = word_x < 0 ? -word_x : 0;
+   const int col1 =
+      word_x + words > FRAME_WORDS ? FRAME_WORDS - word_x : words;
+   if( row0 >= row1 || col0 >= col1 )
+      return;
+
+   switch( mode )
+   {
+      case kBlitCopy:
+         BLIT_ROWS(image->coverage, (d & ~m) | (s & m));
+         break;
+      case kBlitMask:
+         BLIT_ROWS(image->mask + j * image->stride, (d & ~m) | (s & m));
+         break;
+      case kBlitNXOR:
+         BLIT_ROWS(image->mask + j * image->stride, d ^ (~s & m));
+         break;
+   }
+}
@@ -0,0 +1,73 @@
+// Software blitter for drawing 1-bit bitmaps directly to the frame
+// buffer.
+//
+// Bitmaps are converted once to a word-aligned format, and each row is
+// drawn with 32-bit shifts and masks, so that the cost per call is much
+// lower than drawBitmap.  There is no support for flipping, scaling, or
+// stencils, and callers must call markUpdatedRows for rows they draw to.
+
+#ifndef BLIT_H_
+#define BLIT_H_
+
+#include<stdint.h>
+#include"pd_api.h"
+
+typedef enum
+{
+   // Draw all pixels within the bitmap, ignoring its mask.
+   kBlitCopy,
+
+   // Draw only pixels that are opaque in the bitmap mask.  This is the
+   // same as drawBitmap with kDrawModeCopy.
+   kBlitMask,
+
+   // Invert frame buffer pixels where the bitmap is black and opaque.
+   // This is the same as drawBitmap with kDrawModeNXOR.
+   kBlitNXOR,
+} BlitMode;
+
+typedef struct
+{
+   PlaydateAPI *pd;
+   int width, height;
+
+   // Number of words in each row of data and mask.  Each row has one
+   // extra word of zeroes at the start and end, so that shifted rows can
+   // be drawn without special cases for the edges.
+   int stride;
+
+   // Pixel data and mask, with leftmost pixel in the most significant bit
+   // of each word.  Mask bits are set for opaque pixels.
+   uint32_t *data;
+   uint32_t *mask;
+
+   // Mask with all pixels in a single row set, used for kBlitCopy.
+   uint32_t *coverage;
+} BlitImage;
+
+// Load or store 32 frame buffer pixels, with leftmost pixel in the most
+// significant bit.  Frame buffer bytes are stored with leftmost pixel in
+// the most significant bit of the first byte.  Both the device and the
+// host are little endian, so words are byte swapped after loading and
+// before storing, which is a single REV instruction on the device.
+static inline uint32_t LoadPixels(const uint32_t *p)
+{
+   return __builtin_bswap32(*p);
+}
+
+static inline void StorePixels(uint32_t *p, uint32_t pixels)
+{
+   *p = __builtin_bswap32(pixels);
+}
+
+// Convert bitmap to blitter format.  Returns 0 on failure.
+int InitBlitImage(BlitImage *image, PlaydateAPI *pd, LCDBitmap *bitmap);
+
+// Release memory held by image.
+void FreeBlitImage(BlitImage *image);
+
+// Draw image to frame buffer with its top left corner at (x, y).  Image
+// is clipped to screen edges.
+void Blit(uint8_t *frame, const BlitImage *image, int x, int y, BlitMode mode);
+
+#endif  // BLIT_H_
@@ -0,0 +1,158 @@
+#include"chase.h"
+#include<stdint.h>
+#include"kernel.h"
+#include"memory.h"
+
+// Default load counts.
+#define DEFAULT_LOAD_COUNT   0x1000
+
+// Maximum load count.
+#define MAX_LOAD_COUNT       0xfffff
+
+// Default working set size and stride, as log2 of number of bytes.
+#define DEFAULT_SIZE_LOG2    14
+#define DEFAULT_STRIDE_LOG2  5
+
+// Working set ranges from 1K to all of g_memory (8M), stride ranges from
+// one word to 4K.
+#define MIN_SIZE_LOG2        10
+#define MAX_SIZE_LOG2        23
+#define MIN_STRIDE_LOG2      2
+#define MAX_STRIDE_LOG2      12
+
+// Settings.
+static int g_size_log2 = DEFAULT_SIZE_LOG2;
+static int g_stride_log2 = DEFAULT_STRIDE_LOG2;
+
+// Number of loads.
+static int g_chase = DEFAULT_LOAD_COUNT;
+static int g_strided = DEFAULT_LOAD_COUNT;
+static float g_costs[2];
+
+const BenchmarkParam kChaseParams[] =
+{
+   {"size_log2",   &g_size_log2,   MIN_SIZE_LOG2, MAX_SIZE_LOG2, 0, NULL},
+   {"stride_log2", &g_stride_log2, MIN_STRIDE_LOG2, MAX_STRIDE_LOG2, 0, NULL},
+   {"chase",       &g_chase,       0, MAX_LOAD_COUNT, 1, g_costs + 0},
+   {"strided",     &g_strided,     0, MAX_LOAD_COUNT, 1, g_costs + 1},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Settings used to build the current chain.
+static int g_built_size_log2 = -1;
+static int g_built_stride_log2 = -1;
+
+// Number of nodes in chain, and the distance between adjacent nodes in
+// words.
+static int g_node_count = 0;
+static int g_node_words = 1;
+
+// Word index where the next chase starts.  Each frame continues where
+// the previous frame left off, so that loads do not keep revisiting the
+// same few nodes that are already cached.
+static int g_chase_index = 0;
+static int g_strided_index = 0;
+
+// Read result, declared volatile to disable compiler optimizations around
+// it.
+static volatile int g_result = 0;
+
+// Build a single cycle through all nodes of the working set.
+//
+// Each node holds the word index of the next node.  This uses Sattolo's
+// algorithm, which shuffles an array such that mapping each index to its
+// element produces a random cyclic permutation, and does so in place
+// without any extra memory.
+static void BuildChain(void)
+{
+   g_built_size_log2 = g_size_log2;
+   g_built_stride_log2 = g_stride_log2;
+
+   const int stride_log2 = g_stride_log2 < g_size_log2
+                           ? g_stride_log2 : g_size_log2;
+   g_node_count = 1 << (g_size_log2 - stride_log2);
+   g_node_words = 1 << (stride_log2 - 2);
+
+   for(int i = 0; i < g_node_count; i++)
+      g_memory[i * g_node_words] = i * g_node_words;
+
+   // Fixed seed, so that runs are reproducible.  This uses its own
+   // generator instead of srand and rand, so that the random state used
+   // elsewhere is not reset, and so that node counts larger than
+   // RAND_MAX are shuffled without bias.
+   uint32_t seed = 1;
+   for(int i = g_node_count - 1; i > 0; i--)
+   {
+      seed = seed * 1664525u + 1013904223u;
+      const int j = (int)(((uint64_t)seed * (uint32_t)i) >> 32);
+      const int t = g_memory[i * g_node_words];
+      g_memory[i * g_node_words] = g_memory[j * g_node_words];
+      g_memory[j * g_node_words] = t;
+   }
+   g_chase_index = 0;
+   g_strided_index = 0;
+   g_memory_has_chain = 1;
+}
+
+// Follow the chain.  Each load depends on the previous one, so this
+// measures the full latency of each load, unlike the random reads in
+// memory.c where address computation dominates and loads may overlap.
+static void Chase(int count)
+{
+   int index = g_chase_index;
+   for(int i = 0; i < count; i++)
+      index = g_memory[index];
+   g_chase_index = index;
+}
+
+// Load the same nodes in address order.  Addresses do not depend on
+// loaded values, so this shows how much of the chase latency is hidden
+// when loads are independent.
+static void Strided(int count)
+{
+   const int mask = g_node_count * g_node_words - 1;
+   int index = g_strided_index;
+   int sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      sum += g_memory[index];
+      index = (index + g_node_words) & mask;
+   }
+   g_strided_index = index;
+   g_result = sum;
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, NULL, Chase, Strided
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "chase", kChaseParams, kKernels, NULL, 0, &g_state
+};
+
+// Exported functions.
+void ChaseBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   // Rebuilding the chain for large working sets takes a while, so this
+   // is only done when settings change, or when some other benchmark has
+   // overwritten the chain.
+   if( g_memory_has_chain == 0 ||
+       g_size_log2 != g_built_size_log2 ||
+       g_stride_log2 != g_built_stride_log2 )
+   {
+      BuildChain();
+   }
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetChaseBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_LOAD_COUNT);
+   g_size_log2 = DEFAULT_SIZE_LOG2;
+   g_stride_log2 = DEFAULT_STRIDE_LOG2;
+   g_memory_has_chain = 0;
+}
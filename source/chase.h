@@ -0,0 +1,16 @@
+// Benchmark for memory latency, by following a chain of pointers through
+// a random cyclic permutation.
+
+#ifndef CHASE_H_
+#define CHASE_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void ChaseBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetChaseBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kChaseParams[];
+
+#endif  // CHASE_H_
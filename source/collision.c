@@ -0,0 +1,281 @@
+#include"collision.h"
+#include"kernel.h"
+#include"sprite.h"
+
+// Default sprite counts.
+#define DEFAULT_SPRITE_COUNT  100
+
+// Sprite size range.
+#define MIN_SIZE              1
+#define MAX_SIZE              128
+#define DEFAULT_SIZE          8
+
+// Grid cells are square with power of two sizes, at least as large as
+// the sprites so that overlapping sprites are always in the same or
+// adjacent cells.
+#define MIN_CELL_LOG2         3
+#define MAX_GRID_COLUMNS      ((LCD_COLUMNS >> MIN_CELL_LOG2) + 1)
+#define MAX_GRID_ROWS         ((LCD_ROWS >> MIN_CELL_LOG2) + 1)
+
+// Settings.
+static int g_size = DEFAULT_SIZE;
+
+// Number of sprites tested against each other.
+static int g_brute = DEFAULT_SPRITE_COUNT;
+static int g_grid = DEFAULT_SPRITE_COUNT;
+static int g_sprites = DEFAULT_SPRITE_COUNT;
+static int g_mask = DEFAULT_SPRITE_COUNT;
+static float g_costs[4];
+
+const BenchmarkParam kCollisionParams[] =
+{
+   {"size",    &g_size,    MIN_SIZE, MAX_SIZE, 0, NULL},
+   {"brute",   &g_brute,   0, MAX_SPRITES,     1, g_costs + 0},
+   {"grid",    &g_grid,    0, MAX_SPRITES,     1, g_costs + 1},
+   {"sprites", &g_sprites, 0, MAX_SPRITES,     1, g_costs + 2},
+   {"mask",    &g_mask,    0, MAX_SPRITES,     1, g_costs + 3},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Number of overlapping pairs found in the last frame, in the same order
+// as params.
+static float g_pairs[5] = {-1, 0, 0, 0, 0};
+
+// Sprites shared with the sprite benchmark, animated once per frame.
+static const Sprite *g_circles = NULL;
+
+// API handle for kernels that call the SDK.
+static PlaydateAPI *g_pd = NULL;
+
+// Uniform grid.  Each cell holds a linked list of sprites whose top left
+// corner is in that cell.
+static int g_cell_heads[MAX_GRID_ROWS * MAX_GRID_COLUMNS];
+static int g_next[MAX_SPRITES];
+
+// Sprites in the sprite system, used for collision queries only.
+static LCDSprite *g_handles[MAX_SPRITES];
+static int g_handle_count = 0;
+static int g_handle_size = 0;
+
+// Circle bitmap for mask collisions.
+static LCDBitmap *g_bitmap = NULL;
+static int g_bitmap_size = 0;
+
+// Return top left corner of sprite i.
+static inline int Left(int i)
+{
+   return g_circles[i].x - g_size / 2;
+}
+
+static inline int Top(int i)
+{
+   return g_circles[i].y - g_size / 2;
+}
+
+// Return nonzero if bounding boxes of sprites i and j overlap.
+static inline int Overlap(int i, int j)
+{
+   const int dx = Left(i) - Left(j);
+   const int dy = Top(i) - Top(j);
+   return dx < g_size && dx > -g_size && dy < g_size && dy > -g_size;
+}
+
+// Return nonzero if opaque pixels of sprites i and j overlap.
+static int MaskOverlap(int i, int j)
+{
+   const int margin = MAX_SIZE;
+   return g_pd->graphics->checkMaskCollision(
+      g_bitmap, Left(i), Top(i), kBitmapUnflipped,
+      g_bitmap, Left(j), Top(j), kBitmapUnflipped,
+      LCDMakeRect(-margin, -margin,
+                  LCD_COLUMNS + 2 * margin, LCD_ROWS + 2 * margin));
+}
+
+// Test every pair of sprites.
+static void BruteForce(int count)
+{
+   int pairs = 0;
+   for(int i = 0; i < count; i++)
+   {
+      for(int j = i + 1; j < count; j++)
+         pairs += Overlap(i, j);
+   }
+   g_pairs[1] = pairs;
+}
+
+// Return cell coordinate for a pixel coordinate, clamped to grid.
+// Clamping does not change the order of coordinates, so overlapping
+// sprites are still in the same or adjacent cells.
+static inline int CellIndex(int p, int cell_log2, int cells)
+{
+   const int c = p >> cell_log2;
+   return c < 0 ? 0 : (c >= cells ? cells - 1 : c);
+}
+
+// Rebuild grid and count overlapping pairs, optionally checking masks of
+// each overlapping pair.
+static int CountGridPairs(int count, int check_mask)
+{
+   int cell_log2 = MIN_CELL_LOG2;
+   while( (1 << cell_log2) < g_size )
+      cell_log2++;
+   const int columns = (LCD_COLUMNS >> cell_log2) + 1;
+   const int rows = (LCD_ROWS >> cell_log2) + 1;
+
+   for(int i = 0; i < columns * rows; i++)
+      g_cell_heads[i] = -1;
+   for(int i = 0; i < count; i++)
+   {
+      const int cell = CellIndex(Top(i), cell_log2, rows) * columns +
+                       CellIndex(Left(i), cell_log2, columns);
+      g_next[i] = g_cell_heads[cell];
+      g_cell_heads[cell] = i;
+   }
+
+   // Test each sprite against sprites with higher indices in the
+   // surrounding 3x3 cells, so that each pair is tested once.
+   int pairs = 0;
+   for(int i = 0; i < count; i++)
+   {
+      const int cx = CellIndex(Left(i), cell_log2, columns);
+      const int cy = CellIndex(Top(i), cell_log2, rows);
+      for(int y = cy > 0 ? cy - 1 : 0; y <= cy + 1 && y < rows; y++)
+      {
+         for(int x = cx > 0 ? cx - 1 : 0; x <= cx + 1 && x < columns; x++)
+         {
+            for(int j = g_cell_heads[y * columns + x]; j >= 0; j = g_next[j])
+            {
+               if( j > i && Overlap(i, j) &&
+                   (check_mask == 0 || MaskOverlap(i, j)) )
+               {
+                  pairs++;
+               }
+            }
+         }
+      }
+   }
+   return pairs;
+}
+
+static void Grid(int count)
+{
+   g_pairs[2] = CountGridPairs(count, 0);
+}
+
+// Move sprites in the sprite system and query all overlapping pairs.
+static void SpriteQuery(int count)
+{
+   for(int i = 0; i < count; i++)
+      g_pd->sprite->moveTo(g_handles[i], (float)Left(i), (float)Top(i));
+   int length = 0;
+   LCDSprite **overlapping = g_pd->sprite->allOverlappingSprites(&length);
+   if( overlapping != NULL )
+      g_pd->system->realloc(overlapping, 0);
+   g_pairs[3] = length / 2;
+}
+
+// Grid broad phase followed by mask collision checks.
+static void Mask(int count)
+{
+   g_pairs[4] = CountGridPairs(count, 1);
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, BruteForce, Grid, SpriteQuery, Mask
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "collision", kCollisionParams, kKernels, g_pairs, 0, &g_state,
+   "%.0f pairs", NULL, 1
+};
+
+// Add or remove sprites so that the sprite system holds "count" sprites,
+// and update their sizes.  These sprites are not visible, and only have
+// collision rectangles.
+static void ResizeHandles(PlaydateAPI *pd, int count)
+{
+   while( g_handle_count > count )
+   {
+      LCDSprite *sprite = g_handles[--g_handle_count];
+      pd->sprite->removeSprite(sprite);
+      pd->sprite->freeSprite(sprite);
+   }
+   if( g_handle_size != g_size )
+   {
+      g_handle_size = g_size;
+      for(int i = 0; i < g_handle_count; i++)
+      {
+         pd->sprite->setSize(g_handles[i], g_size, g_size);
+         pd->sprite->setCollideRect(g_handles[i],
+                                    PDRectMake(0, 0, g_size, g_size));
+      }
+   }
+   while( g_handle_count < count )
+   {
+      LCDSprite *sprite = pd->sprite->newSprite();
+      pd->sprite->setSize(sprite, g_size, g_size);
+      pd->sprite->setCenter(sprite, 0, 0);
+      pd->sprite->setCollideRect(sprite, PDRectMake(0, 0, g_size, g_size));
+      pd->sprite->setVisible(sprite, 0);
+      pd->sprite->addSprite(sprite);
+      g_handles[g_handle_count++] = sprite;
+   }
+}
+
+// Initialize or update circle bitmap.
+static void UpdateBitmap(PlaydateAPI *pd)
+{
+   if( g_bitmap_size == g_size )
+      return;
+   g_bitmap_size = g_size;
+
+   if( g_bitmap != NULL )
+      pd->graphics->freeBitmap(g_bitmap);
+   g_bitmap = pd->graphics->newBitmap(g_size, g_size, kColorClear);
+   pd->graphics->pushContext(g_bitmap);
+   const int r = g_size / 2;
+   for(int y = 0; y < g_size; y++)
+   {
+      for(int x = 0; x < g_size; x++)
+      {
+         if( (x - r) * (x - r) + (y - r) * (y - r) <= r * r )
+            pd->graphics->setPixel(x, y, kColorBlack);
+      }
+   }
+   pd->graphics->popContext();
+}
+
+// Exported functions.
+void CollisionBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_pd = pd;
+   UpdateBitmap(pd);
+   ResizeHandles(pd, g_sprites);
+
+   // All kernels use the same sprites, so only the largest count is
+   // animated.
+   int count = 0;
+   for(const BenchmarkParam *p = kCollisionParams; p->name != NULL; p++)
+   {
+      if( p->is_count != 0 && count < *p->value )
+         count = *p->value;
+   }
+   g_circles = AnimateCircles(count);
+
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ExitCollisionBenchmark(PlaydateAPI *pd)
+{
+   ResizeHandles(pd, 0);
+}
+
+void ResetCollisionBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_SPRITE_COUNT);
+   g_size = DEFAULT_SIZE;
+}
@@ -0,0 +1,19 @@
+// Benchmark for broad-phase collision detection between sprites.
+
+#ifndef COLLISION_H_
+#define COLLISION_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void CollisionBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetCollisionBenchmark(void);
+
+// Remove sprites added to the sprite system, called when switching to a
+// different benchmark.
+void ExitCollisionBenchmark(PlaydateAPI *pd);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kCollisionParams[];
+
+#endif  // COLLISION_H_
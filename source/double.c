@@ -0,0 +1,172 @@
+#include"double.h"
+#include"kernel.h"
+#include"timer.h"
+
+// Default operation counts.  This is lower than the arithmetic benchmark
+// since double precision operations are library calls.
+#define DEFAULT_OPERATION_COUNT  0x400
+
+// Maximum operation count.
+#define MAX_COUNT                0xffffff
+
+// Operation counts.
+static int g_double_add = DEFAULT_OPERATION_COUNT;
+static int g_double_mul = DEFAULT_OPERATION_COUNT;
+static int g_double_div = DEFAULT_OPERATION_COUNT;
+static int g_float_div = DEFAULT_OPERATION_COUNT;
+static int g_convert = DEFAULT_OPERATION_COUNT;
+static int g_mul_float = DEFAULT_OPERATION_COUNT;
+static int g_mul_double = DEFAULT_OPERATION_COUNT;
+static int g_format = DEFAULT_OPERATION_COUNT;
+static float g_costs[8];
+
+const BenchmarkParam kDoubleParams[] =
+{
+   {"double_add", &g_double_add, 0, MAX_COUNT, 1, g_costs + 0},
+   {"double_mul", &g_double_mul, 0, MAX_COUNT, 1, g_costs + 1},
+   {"double_div", &g_double_div, 0, MAX_COUNT, 1, g_costs + 2},
+   {"float_div",  &g_float_div,  0, MAX_COUNT, 1, g_costs + 3},
+   {"convert",    &g_convert,    0, MAX_COUNT, 1, g_costs + 4},
+   {"mul_float",  &g_mul_float,  0, MAX_COUNT, 1, g_costs + 5},
+   {"mul_double", &g_mul_double, 0, MAX_COUNT, 1, g_costs + 6},
+   {"format",     &g_format,     0, MAX_COUNT, 1, g_costs + 7},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Results, declared volatile to disable compiler optimizations around
+// them.
+static volatile float g_float_result = 1;
+static volatile double g_double_result = 1;
+
+// Operands, declared volatile so that the compiler can not fold them into
+// the operations, or replace divisions with multiplications.
+static volatile double g_double_multiplier = 1.0001;
+static volatile float g_float_operand = 1.5f;
+static volatile float g_float_divisor = 3.0f;
+static volatile double g_double_divisor = 3.0;
+
+// API handle for kernels that call formatString.
+static PlaydateAPI *g_pd = NULL;
+
+// Kernels.  As with arith.c, most operations include conversion from
+// integer operands.
+
+static void DoubleAdd(int count)
+{
+   for(int i = 0; i < count; i++)
+      g_double_result += i;
+}
+
+static void DoubleMul(int count)
+{
+   const double multiplier = g_double_multiplier;
+   for(int i = 0; i < count; i++)
+      g_double_result = i * multiplier;
+}
+
+static void DoubleDiv(int count)
+{
+   const double divisor = g_double_divisor;
+   for(int i = 0; i < count; i++)
+      g_double_result = i / divisor;
+}
+
+static void FloatDiv(int count)
+{
+   const float divisor = g_float_divisor;
+   for(int i = 0; i < count; i++)
+      g_float_result = i / divisor;
+}
+
+// Convert float to double and back.
+static void Convert(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      g_double_result = g_float_result;
+      g_float_result = g_double_result;
+   }
+}
+
+// Multiply a float by a float literal.
+static void MulFloat(int count)
+{
+   for(int i = 0; i < count; i++)
+      g_float_result = g_float_operand * 1.0001f;
+}
+
+// Multiply a float by a double literal, which is easy to write by
+// accident.  The float operand is promoted to double, which is made
+// explicit here so that -Wdouble-promotion does not flag it.
+static void MulDouble(int count)
+{
+   for(int i = 0; i < count; i++)
+      g_float_result = (float)((double)g_float_operand * 1.0001);
+}
+
+// Format a float.  Variadic functions always promote float arguments to
+// double, so the cost includes a conversion in addition to the formatting.
+static void Format(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      char *text = NULL;
+      g_pd->system->formatString(&text, "%.2f", (double)g_float_result);
+      g_pd->system->realloc(text, 0);
+   }
+}
+
+// Format an integer with the same call, as a baseline for Format.
+static void FormatInt(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      char *text = NULL;
+      g_pd->system->formatString(&text, "%d", i);
+      g_pd->system->realloc(text, 0);
+   }
+}
+
+// Measured cycles per FormatInt operation.  This is shown next to the
+// cost of Format instead of on a line of its own, since all lines are
+// taken.
+static float g_format_int_cost = 0;
+static float g_extra[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+
+static const KernelFunction kKernels[] =
+{
+   DoubleAdd, DoubleMul, DoubleDiv, FloatDiv,
+   Convert, MulFloat, MulDouble, Format
+};
+
+// Each kernel runs one operation per loop iteration.
+static const int kOpsPerIteration[] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "double", kDoubleParams, kKernels, g_extra, 0, &g_state,
+   "%.2f ns for %%d", kOpsPerIteration
+};
+
+// Exported functions.
+void DoubleBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_pd = pd;
+
+   // Time baseline with the same count as Format.
+   const uint32_t t0 = GetTimestamp(pd);
+   FormatInt(g_format);
+   const uint32_t t1 = GetTimestamp(pd);
+   UpdateCost(&g_format_int_cost, t1 - t0, g_format);
+   g_extra[7] = CyclesToNanoseconds(g_format_int_cost);
+
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetDoubleBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_OPERATION_COUNT);
+   g_format_int_cost = 0;
+}
@@ -0,0 +1,19 @@
+// Benchmark for double precision operations, compared with single
+// precision.
+//
+// The device FPU only supports single precision, so double precision
+// operations are library calls.
+
+#ifndef DOUBLE_H_
+#define DOUBLE_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void DoubleBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetDoubleBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kDoubleParams[];
+
+#endif  // DOUBLE_H_
@@ -0,0 +1,192 @@
+#include"fill.h"
+#include<stdint.h>
+#include<string.h>
+#include"blit.h"
+#include"kernel.h"
+#include"timer.h"
+
+// Default fill counts.
+#define DEFAULT_FILL_COUNT  100
+
+// Maximum fill count.
+#define MAX_COUNT           10000
+
+// Region size ranges from 1x1 to 256x128 pixels.
+#define MAX_WIDTH_LOG2      8
+#define MAX_HEIGHT_LOG2     7
+#define DEFAULT_SIZE_LOG2   5
+
+// Settings.  "x" is the left edge of the region, which sets its alignment
+// within bytes and words.  Top edge is always row 0, so that the region
+// is covered by status text.
+static int g_x = 0;
+static int g_width_log2 = DEFAULT_SIZE_LOG2;
+static int g_height_log2 = DEFAULT_SIZE_LOG2;
+
+// Number of fills.
+static int g_words = DEFAULT_FILL_COUNT;
+static int g_memset = DEFAULT_FILL_COUNT;
+static int g_solid = DEFAULT_FILL_COUNT;
+static int g_pattern = DEFAULT_FILL_COUNT;
+static float g_costs[4];
+
+const BenchmarkParam kFillParams[] =
+{
+   {"x",           &g_x,           0, 31,              0, NULL},
+   {"width_log2",  &g_width_log2,  0, MAX_WIDTH_LOG2,  0, NULL},
+   {"height_log2", &g_height_log2, 0, MAX_HEIGHT_LOG2, 0, NULL},
+   {"words",       &g_words,       0, MAX_COUNT,       1, g_costs + 0},
+   {"memset",      &g_memset,      0, MAX_COUNT,       1, g_costs + 1},
+   {"solid",       &g_solid,       0, MAX_COUNT,       1, g_costs + 2},
+   {"pattern",     &g_pattern,     0, MAX_COUNT,       1, g_costs + 3},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Throughput of each kernel in pixels per millisecond, in the same order
+// as params.  Settings and kernels without measurements are set to -1.
+static float g_throughput[7] = {-1, -1, -1, -1, -1, -1, -1};
+#define FIRST_KERNEL_INDEX  3
+
+// 50% checkerboard patterns, 8 rows of pixels followed by 8 rows of
+// mask.  The second pattern is the inverse of the first.
+static const LCDPattern kCheckerboard =
+{
+   0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55,
+   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+static const LCDPattern kInverseCheckerboard =
+{
+   0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa,
+   0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+// Frame buffer and API handle for the current frame.
+static uint8_t *g_frame = NULL;
+static PlaydateAPI *g_pd = NULL;
+
+// Kernels.  Each fill alternates between black and white, so that the
+// frame buffer contents change with every call.
+
+// 32-bit stores, with read-modify-write for partial words at the edges.
+static void FillWords(int count)
+{
+   const int x0 = g_x;
+   const int x1 = g_x + (1 << g_width_log2);
+   const int height = 1 << g_height_log2;
+   const int first = x0 >> 5;
+   const int last = (x1 - 1) >> 5;
+   uint32_t left = ~0u >> (x0 & 31);
+   const uint32_t right = ~0u << (31 - ((x1 - 1) & 31));
+   if( first == last )
+      left &= right;
+
+   for(int i = 0; i < count; i++)
+   {
+      const uint32_t color = (i & 1) != 0 ? ~0u : 0;
+      for(int y = 0; y < height; y++)
+      {
+         uint32_t *row = (uint32_t *)(g_frame + y * LCD_ROWSIZE);
+         StorePixels(row + first,
+                     (LoadPixels(row + first) & ~left) | (color & left));
+         if( first == last )
+            continue;
+         for(int w = first + 1; w < last; w++)
+            row[w] = color;
+         StorePixels(row + last,
+                     (LoadPixels(row + last) & ~right) | (color & right));
+      }
+   }
+}
+
+// memset for whole bytes, with read-modify-write for partial bytes at
+// the edges.
+static void FillBytes(int count)
+{
+   const int x0 = g_x;
+   const int x1 = g_x + (1 << g_width_log2);
+   const int height = 1 << g_height_log2;
+   const int first = x0 >> 3;
+   const int last = (x1 - 1) >> 3;
+   uint8_t left = (uint8_t)(0xff >> (x0 & 7));
+   const uint8_t right = (uint8_t)(0xff << (7 - ((x1 - 1) & 7)));
+   if( first == last )
+      left &= right;
+
+   for(int i = 0; i < count; i++)
+   {
+      const uint8_t color = (i & 1) != 0 ? 0xff : 0;
+      for(int y = 0; y < height; y++)
+      {
+         uint8_t *row = g_frame + y * LCD_ROWSIZE;
+         row[first] = (uint8_t)((row[first] & ~left) | (color & left));
+         if( first == last )
+            continue;
+         memset(row + first + 1, color, last - first - 1);
+         row[last] = (uint8_t)((row[last] & ~right) | (color & right));
+      }
+   }
+}
+
+// fillRect with solid colors.
+static void FillSolid(int count)
+{
+   const int width = 1 << g_width_log2;
+   const int height = 1 << g_height_log2;
+   for(int i = 0; i < count; i++)
+   {
+      g_pd->graphics->fillRect(g_x, 0, width, height,
+                               (i & 1) != 0 ? kColorWhite : kColorBlack);
+   }
+}
+
+// fillRect with a pattern, alternating with its inverse so that every
+// call is a pattern fill.
+static void FillPattern(int count)
+{
+   const int width = 1 << g_width_log2;
+   const int height = 1 << g_height_log2;
+   for(int i = 0; i < count; i++)
+   {
+      g_pd->graphics->fillRect(
+         g_x, 0, width, height,
+         (i & 1) != 0 ? (LCDColor)kCheckerboard
+                      : (LCDColor)kInverseCheckerboard);
+   }
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, NULL, NULL, FillWords, FillBytes, FillSolid, FillPattern
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "fill", kFillParams, kKernels, g_throughput, 0, &g_state, "%.0f px/ms"
+};
+
+// Exported functions.
+void FillBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   g_pd = pd;
+   g_frame = pd->graphics->getFrame();
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+
+   const float pixels = (float)((1 << g_width_log2) << g_height_log2);
+   for(int i = 0; i < 4; i++)
+   {
+      const float ns = CyclesToNanoseconds(g_costs[i]);
+      g_throughput[FIRST_KERNEL_INDEX + i] = ns > 0 ? pixels * 1e6f / ns : -1;
+   }
+}
+
+void ResetFillBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_FILL_COUNT);
+   g_x = 0;
+   g_width_log2 = DEFAULT_SIZE_LOG2;
+   g_height_log2 = DEFAULT_SIZE_LOG2;
+   for(int i = FIRST_KERNEL_INDEX; i < 7; i++)
+      g_throughput[i] = -1;
+}
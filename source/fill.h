@@ -0,0 +1,16 @@
+// Benchmark for filling rectangles in the frame buffer directly, compared
+// with fillRect.
+
+#ifndef FILL_H_
+#define FILL_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void FillBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetFillBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kFillParams[];
+
+#endif  // FILL_H_
@@ -0,0 +1,136 @@
+#include"fixed.h"
+#include"kernel.h"
+
+// Default operation counts.  This is lower than the arithmetic benchmark
+// since some of these operations are library calls.
+#define DEFAULT_OPERATION_COUNT  0x2000
+
+// Maximum operation count.
+#define MAX_OPERATION_COUNT      0xffffff
+
+// Operation counts.
+static int g_fixed_mul = DEFAULT_OPERATION_COUNT;
+static int g_fixed_div = DEFAULT_OPERATION_COUNT;
+static int g_int_div = DEFAULT_OPERATION_COUNT;
+static int g_int_mod = DEFAULT_OPERATION_COUNT;
+static int g_shift = DEFAULT_OPERATION_COUNT;
+static int g_smull = DEFAULT_OPERATION_COUNT;
+static int g_smlal = DEFAULT_OPERATION_COUNT;
+
+// Measured cycles per operation.
+static float g_fixed_mul_cost = 0;
+static float g_fixed_div_cost = 0;
+static float g_int_div_cost = 0;
+static float g_int_mod_cost = 0;
+static float g_shift_cost = 0;
+static float g_smull_cost = 0;
+static float g_smlal_cost = 0;
+
+const BenchmarkParam kFixedPointParams[] =
+{
+   {"fixed_mul", &g_fixed_mul, 0, MAX_OPERATION_COUNT, 1, &g_fixed_mul_cost},
+   {"fixed_div", &g_fixed_div, 0, MAX_OPERATION_COUNT, 1, &g_fixed_div_cost},
+   {"int_div",   &g_int_div,   0, MAX_OPERATION_COUNT, 1, &g_int_div_cost},
+   {"int_mod",   &g_int_mod,   0, MAX_OPERATION_COUNT, 1, &g_int_mod_cost},
+   {"shift",     &g_shift,     0, MAX_OPERATION_COUNT, 1, &g_shift_cost},
+   {"smull",     &g_smull,     0, MAX_OPERATION_COUNT, 1, &g_smull_cost},
+   {"smlal",     &g_smlal,     0, MAX_OPERATION_COUNT, 1, &g_smlal_cost},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Kernels.  As with arith.c, intermediate results are declared volatile
+// to disable compiler optimizations around them.  Accumulators are
+// unsigned so that wraparound is well defined.
+//
+// Divisors are derived from the loop index so that they are never zero
+// and can not be replaced with multiplications by a constant reciprocal.
+// Dividends are kept large since the Cortex-M7 divider finishes early
+// for small quotients.
+
+// 16.16 fixed point multiply with 64-bit intermediate (SMULL + shifts).
+static void FixedMul(int count)
+{
+   volatile int32_t result = 1 << 16;
+   for(int i = 0; i < count; i++)
+      result = (int32_t)(((int64_t)result * (i + (1 << 16))) >> 16);
+}
+
+// 16.16 fixed point divide, which needs a 64-bit dividend.  There is no
+// 64-bit divide instruction, so this is a call to __aeabi_ldivmod.
+static void FixedDiv(int count)
+{
+   volatile uint32_t result = 0;
+   for(int i = 0; i < count; i++)
+   {
+      result += (uint32_t)(((int64_t)(INT32_MAX - i) << 16) /
+                           ((i & 0xffff) + (1 << 16)));
+   }
+}
+
+// 32-bit divide (SDIV).
+static void IntDiv(int count)
+{
+   volatile uint32_t result = 0;
+   for(int i = 0; i < count; i++)
+      result += (uint32_t)((INT32_MAX - i) / ((i & 0xff) + 1));
+}
+
+// 32-bit modulus (SDIV + MLS).  This is the same operation as
+// "Rand() % g_rand_write" in memory.c.
+static void IntMod(int count)
+{
+   volatile uint32_t result = 0;
+   for(int i = 0; i < count; i++)
+      result += (uint32_t)((INT32_MAX - i) % ((i & 0xff) + 1));
+}
+
+// Shift by a variable amount.
+static void Shift(int count)
+{
+   volatile uint32_t result = 0;
+   for(int i = 0; i < count; i++)
+      result += (uint32_t)i << (i & 31);
+}
+
+// High word of 32x32 to 64-bit signed multiply (SMULL).
+static void Smull(int count)
+{
+   volatile uint32_t result = 0;
+   for(int i = 0; i < count; i++)
+      result += (uint32_t)(((int64_t)i * 0x6b43a9b5) >> 32);
+}
+
+// 32x32 multiply with 64-bit accumulate (SMLAL).
+static void Smlal(int count)
+{
+   volatile uint64_t result = 0;
+   for(int i = 0; i < count; i++)
+      result += (uint64_t)((int64_t)i * (INT32_MAX - i));
+}
+
+static const KernelFunction kKernels[] =
+{
+   FixedMul, FixedDiv, IntDiv, IntMod, Shift, Smull, Smlal
+};
+
+// Each kernel runs one operation per loop iteration.
+static const int kOpsPerIteration[] = {1, 1, 1, 1, 1, 1, 1};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "fixed point", kFixedPointParams, kKernels, NULL, 0, &g_state, NULL,
+   kOpsPerIteration
+};
+
+// Exported functions.
+void FixedPointBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetFixedPointBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_OPERATION_COUNT);
+}
@@ -0,0 +1,16 @@
+// Benchmark for fixed point and integer operations that are more expensive
+// than add/mul: division, modulus, shifts, and 64-bit products.
+
+#ifndef FIXED_H_
+#define FIXED_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void FixedPointBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetFixedPointBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kFixedPointParams[];
+
+#endif  // FIXED_H_
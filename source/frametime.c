@@ -0,0 +1,145 @@
+#include"frametime.h"
+#include<math.h>
+#include"timer.h"
+
+// Number of frames to keep, one frame per pixel column in the graph.
+#define FRAME_HISTORY     LCD_COLUMNS
+
+// Histogram bins for computing percentiles.  Each bin covers 0.1ms, and
+// frames longer than 100ms all go to the last bin.
+#define BIN_COUNT         1000
+#define CYCLES_PER_BIN    (CPU_CLOCK_MHZ * 100)
+#define MS_PER_BIN        0.1f
+
+// Overlay position.
+#define OVERLAY_Y         (LCD_ROWS - 34)
+#define GRAPH_HEIGHT      14
+
+// Ring buffer of frame times in cycles.
+static uint32_t g_history[FRAME_HISTORY];
+static int g_history_index = 0;
+static int g_history_size = 0;
+
+// Histogram of frames in g_history.
+static uint16_t g_histogram[BIN_COUNT];
+
+// Timestamp of last call to RecordFrameTime.
+static uint32_t g_last_timestamp = 0;
+static int g_has_last_timestamp = 0;
+
+// Return histogram bin for a frame time.
+static int Bin(uint32_t cycles)
+{
+   const uint32_t bin = cycles / CYCLES_PER_BIN;
+   return bin < BIN_COUNT ? (int)bin : BIN_COUNT - 1;
+}
+
+// Return upper bound of the bin containing the given percentile.
+static float Percentile(int percent)
+{
+   const int target = (g_history_size * percent + 99) / 100;
+   int count = 0;
+   for(int i = 0; i < BIN_COUNT; i++)
+   {
+      count += g_histogram[i];
+      if( count >= target )
+         return (i + 1) * MS_PER_BIN;
+   }
+   return BIN_COUNT * MS_PER_BIN;
+}
+
+// Return the longest frame in history, in cycles.
+static uint32_t MaxFrameTime(void)
+{
+   uint32_t max = 0;
+   for(int i = 0; i < g_history_size; i++)
+   {
+      if( max < g_history[i] )
+         max = g_history[i];
+   }
+   return max;
+}
+
+// Exported functions.
+void RecordFrameTime(PlaydateAPI *pd)
+{
+   const uint32_t now = GetTimestamp(pd);
+   if( g_has_last_timestamp != 0 )
+   {
+      const uint32_t t = now - g_last_timestamp;
+      if( g_history_size == FRAME_HISTORY )
+         g_histogram[Bin(g_history[g_history_index])]--;
+      else
+         g_history_size++;
+      g_history[g_history_index] = t;
+      g_histogram[Bin(t)]++;
+      g_history_index = (g_history_index + 1) % FRAME_HISTORY;
+   }
+   g_last_timestamp = now;
+   g_has_last_timestamp = 1;
+}
+
+void ResetFrameTime(void)
+{
+   for(int i = 0; i < BIN_COUNT; i++)
+      g_histogram[i] = 0;
+   g_history_index = g_history_size = 0;
+   g_has_last_timestamp = 0;
+}
+
+void GetFrameTimeStats(FrameTimeStats *stats)
+{
+   stats->count = g_history_size;
+   if( g_history_size == 0 )
+   {
+      stats->p50 = stats->p95 = stats->p99 = stats->max = 0;
+      return;
+   }
+   stats->max = CyclesToNanoseconds(MaxFrameTime()) * 1e-6f;
+
+   // Percentiles are rounded up to the bin boundary, which could exceed
+   // the exact maximum.
+   stats->p50 = fminf(Percentile(50), stats->max);
+   stats->p95 = fminf(Percentile(95), stats->max);
+   stats->p99 = fminf(Percentile(99), stats->max);
+}
+
+void DrawFrameTimeOverlay(PlaydateAPI *pd)
+{
+   FrameTimeStats stats;
+   GetFrameTimeStats(&stats);
+
+   pd->graphics->fillRect(
+      0, OVERLAY_Y, LCD_COLUMNS, LCD_ROWS - OVERLAY_Y, kColorWhite);
+   pd->graphics->setDrawMode(kDrawModeCopy);
+
+   char *text = NULL;
+   const int length = pd->system->formatString(
+      &text,
+      "ms: 50%% = %.1f, 95%% = %.1f, 99%% = %.1f, max = %.1f",
+      (double)stats.p50, (double)stats.p95, (double)stats.p99,
+      (double)stats.max);
+   pd->graphics->drawText(text, length, kASCIIEncoding, 5, OVERLAY_Y);
+   pd->system->realloc(text, 0);
+
+   // Draw graph directly to frame buffer, with oldest frame on the left.
+   // Heights are scaled relative to the longest frame.
+   const uint32_t max = MaxFrameTime();
+   if( max > 0 )
+   {
+      uint8_t *frame = pd->graphics->getFrame();
+      const int start = g_history_index - g_history_size + FRAME_HISTORY;
+      for(int x = 0; x < g_history_size; x++)
+      {
+         const uint32_t t = g_history[(start + x) % FRAME_HISTORY];
+         int height = (int)((float)t * GRAPH_HEIGHT / max);
+         if( height < 1 )
+            height = 1;
+         const uint8_t bit = (uint8_t)(0x80 >> (x & 7));
+         for(int y = LCD_ROWS - height; y < LCD_ROWS; y++)
+            frame[y * LCD_ROWSIZE + (x >> 3)] &= (uint8_t)~bit;
+      }
+   }
+
+   pd->graphics->markUpdatedRows(OVERLAY_Y, LCD_ROWS - 1);
+}
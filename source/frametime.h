@@ -0,0 +1,33 @@
+// Frame time recorder.
+//
+// Keeps a history of frame durations, to catch hitches that are hidden
+// by the smoothed frame rate reported by getFPS.
+
+#ifndef FRAMETIME_H_
+#define FRAMETIME_H_
+
+#include"pd_api.h"
+
+// Frame time statistics, in milliseconds.
+typedef struct
+{
+   float p50, p95, p99, max;
+
+   // Number of frames in history.
+   int count;
+} FrameTimeStats;
+
+// Record time since last call.  This should be called once per frame.
+void RecordFrameTime(PlaydateAPI *pd);
+
+// Drop all recorded frames.
+void ResetFrameTime(void);
+
+// Compute statistics over recorded frames.
+void GetFrameTimeStats(FrameTimeStats *stats);
+
+// Draw statistics and a graph of recent frame times at the bottom of
+// the screen, and mark those rows as updated.
+void DrawFrameTimeOverlay(PlaydateAPI *pd);
+
+#endif  // FRAMETIME_H_
@@ -0,0 +1,1064 @@
+#include"host_api.h"
+#include<math.h>
+#include<stdarg.h>
+#include<stdio.h>
+#include<string.h>
+#include<time.h>
+
+// Maximum number of nested pushContext calls.
+#define MAX_CONTEXT_DEPTH  16
+
+// Bitmap layout follows the device: 1 bit per pixel with most significant
+// bit on the left, set bits are white.  Mask bits are set for opaque
+// pixels, and mask is NULL for bitmaps that are fully opaque.
+struct LCDBitmap
+{
+   int width, height, rowbytes;
+   uint8_t *data;
+   uint8_t *mask;
+};
+
+// Software framebuffer, and copy of the rows that were last flushed.
+static uint8_t g_frame[LCD_ROWSIZE * LCD_ROWS];
+static uint8_t g_display_frame[LCD_ROWSIZE * LCD_ROWS];
+static LCDBitmap g_screen = {LCD_COLUMNS, LCD_ROWS, LCD_ROWSIZE, g_frame, NULL};
+
+// Drawing context stack.
+static LCDBitmap *g_context[MAX_CONTEXT_DEPTH];
+static int g_context_depth = 0;
+static LCDBitmapDrawMode g_draw_mode = kDrawModeCopy;
+static LCDSolidColor g_background_color = kColorWhite;
+
+// Clip rectangle for drawBitmap to screen.  This is set by setClipRect and
+// by the sprite system.
+static LCDRect g_clip = {0, LCD_COLUMNS, 0, LCD_ROWS};
+
+// Stencil for bitmap drawing, NULL if not set.  White stencil pixels are
+// drawn, and tiled stencils repeat across the target.
+static LCDBitmap *g_stencil = NULL;
+static int g_stencil_tiled = 0;
+
+// Rows marked by markUpdatedRows in the current frame.
+static uint8_t g_updated_rows[LCD_ROWS];
+static int g_updated_row_count = 0;
+
+// Timer states, in seconds.
+static double g_elapsed_time_start = 0;
+static double g_last_frame_time = 0;
+static float g_fps = 0;
+
+// Return monotonic time in seconds.
+static double Now(void)
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Pixel operations.
+
+// Return current drawing target.
+static LCDBitmap *Target(void)
+{
+   return g_context_depth > 0 ? g_context[g_context_depth - 1] : &g_screen;
+}
+
+static int GetBit(const uint8_t *row, int x)
+{
+   return (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+static void SetBit(uint8_t *row, int x, int bit)
+{
+   const uint8_t b = (uint8_t)(0x80 >> (x & 7));
+   if( bit != 0 )
+      row[x >> 3] |= b;
+   else
+      row[x >> 3] &= (uint8_t)~b;
+}
+
+// Write an opaque pixel to target.
+static void WritePixel(LCDBitmap *target, int x, int y, int white)
+{
+   SetBit(target->data + y * target->rowbytes, x, white);
+   if( target->mask != NULL )
+      SetBit(target->mask + y * target->rowbytes, x, 1);
+}
+
+// Apply color to a single pixel, with clipping.
+static void ApplyColor(LCDBitmap *target, int x, int y, LCDColor color)
+{
+   if( x < 0 || x >= target->width || y < 0 || y >= target->height )
+      return;
+   const uint8_t *row = target->data + y * target->rowbytes;
+   switch( color )
+   {
+      case kColorBlack:
+         WritePixel(target, x, y, 0);
+         break;
+      case kColorWhite:
+         WritePixel(target, x, y, 1);
+         break;
+      case kColorClear:
+         if( target->mask != NULL )
+            SetBit(target->mask + y * target->rowbytes, x, 0);
+         break;
+      case kColorXOR:
+         WritePixel(target, x, y, !GetBit(row, x));
+         break;
+      default:
+         {
+            // Colors other than the solid colors are pointers to patterns,
+            // with 8 rows of pixels followed by 8 rows of mask.
+            const uint8_t *pattern = (const uint8_t*)color;
+            if( GetBit(pattern + 8 + (y & 7), x & 7) != 0 )
+               WritePixel(target, x, y, GetBit(pattern + (y & 7), x & 7));
+         }
+         break;
+   }
+}
+
+// playdate->system functions.
+
+static void *HostRealloc(void *ptr, size_t size)
+{
+   if( size == 0 )
+   {
+      free(ptr);
+      return NULL;
+   }
+   return realloc(ptr, size);
+}
+
+static int HostFormatString(char **ret, const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   const int length = vsnprintf(NULL, 0, fmt, args);
+   va_end(args);
+
+   *ret = malloc(length + 1);
+   va_start(args, fmt);
+   vsnprintf(*ret, length + 1, fmt, args);
+   va_end(args);
+   return length;
+}
+
+static void HostLogToConsole(const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+   fputc('\n', stderr);
+}
+
+static void HostError(const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+   fputc('\n', stderr);
+   exit(EXIT_FAILURE);
+}
+
+static unsigned int HostGetCurrentTimeMilliseconds(void)
+{
+   return (unsigned int)(Now() * 1000.0);
+}
+
+static void HostGetButtonState(PDButtons *current,
+                               PDButtons *pushed,
+                               PDButtons *released)
+{
+   // Host runs are not interactive, so no buttons are ever held.
+   if( current != NULL ) { *current = 0; }
+   if( pushed != NULL ) { *pushed = 0; }
+   if( released != NULL ) { *released = 0; }
+}
+
+static float HostGetCrankChange(void)
+{
+   return 0;
+}
+
+static float HostGetElapsedTime(void)
+{
+   return (float)(Now() - g_elapsed_time_start);
+}
+
+static void HostResetElapsedTime(void)
+{
+   g_elapsed_time_start = Now();
+}
+
+static const struct playdate_sys kHostSystem =
+{
+   .realloc = HostRealloc,
+   .formatString = HostFormatString,
+   .logToConsole = HostLogToConsole,
+   .error = HostError,
+   .getCurrentTimeMilliseconds = HostGetCurrentTimeMilliseconds,
+   .getButtonState = HostGetButtonState,
+   .getCrankChange = HostGetCrankChange,
+   .getElapsedTime = HostGetElapsedTime,
+   .resetElapsedTime = HostResetElapsedTime,
+};
+
+// playdate->graphics functions.
+
+static void HostFillRect(int x, int y, int width, int height, LCDColor color)
+{
+   LCDBitmap *target = Target();
+   const int x0 = x < 0 ? 0 : x;
+   const int y0 = y < 0 ? 0 : y;
+   const int x1 = x + width > target->width ? target->width : x + width;
+   const int y1 = y + height > target->height ? target->height : y + height;
+   for(int py = y0; py < y1; py++)
+   {
+      for(int px = x0; px < x1; px++)
+         ApplyColor(target, px, py, color);
+   }
+}
+
+static void HostClear(LCDColor color)
+{
+   LCDBitmap *target = Target();
+   if( color == kColorBlack || color == kColorWhite )
+   {
+      memset(target->data, color == kColorWhite ? 0xff : 0,
+             target->rowbytes * target->height);
+      if( target->mask != NULL )
+         memset(target->mask, 0xff, target->rowbytes * target->height);
+      return;
+   }
+   HostFillRect(0, 0, target->width, target->height, color);
+}
+
+static LCDBitmapDrawMode HostSetDrawMode(LCDBitmapDrawMode mode)
+{
+   const LCDBitmapDrawMode previous = g_draw_mode;
+   g_draw_mode = mode;
+   return previous;
+}
+
+static void HostPushContext(LCDBitmap *target)
+{
+   if( g_context_depth >= MAX_CONTEXT_DEPTH )
+      HostError("pushContext: too many nested contexts");
+   g_context[g_context_depth++] = target != NULL ? target : &g_screen;
+}
+
+static void HostPopContext(void)
+{
+   if( g_context_depth > 0 )
+      g_context_depth--;
+}
+
+// Return nonzero if stencil allows drawing to target pixel (x, y).
+static int StencilAllows(int x, int y)
+{
+   if( g_stencil == NULL )
+      return 1;
+   if( g_stencil_tiled != 0 )
+   {
+      x %= g_stencil->width;
+      y %= g_stencil->height;
+   }
+   else if( x >= g_stencil->width || y >= g_stencil->height )
+   {
+      return 0;
+   }
+   return GetBit(g_stencil->data + y * g_stencil->rowbytes, x);
+}
+
+// Draw bitmap pixel (sx, sy) to target pixel (tx, ty), applying clipping,
+// stencil, mask, and draw mode.
+static void DrawBitmapPixel(LCDBitmap *target, const LCDBitmap *bitmap,
+                            int sx, int sy, int tx, int ty)
+{
+   if( tx < 0 || tx >= target->width || ty < 0 || ty >= target->height ||
+       StencilAllows(tx, ty) == 0 )
+   {
+      return;
+   }
+   if( target == &g_screen &&
+       (tx < g_clip.left || tx >= g_clip.right ||
+        ty < g_clip.top || ty >= g_clip.bottom) )
+   {
+      return;
+   }
+   if( bitmap->mask != NULL &&
+       GetBit(bitmap->mask + sy * bitmap->rowbytes, sx) == 0 )
+   {
+      return;
+   }
+
+   const int s = GetBit(bitmap->data + sy * bitmap->rowbytes, sx);
+   const uint8_t *dst = target->data + ty * target->rowbytes;
+   switch( g_draw_mode )
+   {
+      case kDrawModeCopy:
+         WritePixel(target, tx, ty, s);
+         break;
+      case kDrawModeWhiteTransparent:
+         if( s == 0 ) { WritePixel(target, tx, ty, 0); }
+         break;
+      case kDrawModeBlackTransparent:
+         if( s != 0 ) { WritePixel(target, tx, ty, 1); }
+         break;
+      case kDrawModeFillWhite:
+         WritePixel(target, tx, ty, 1);
+         break;
+      case kDrawModeFillBlack:
+         WritePixel(target, tx, ty, 0);
+         break;
+      case kDrawModeXOR:
+         WritePixel(target, tx, ty, GetBit(dst, tx) ^ s);
+         break;
+      case kDrawModeNXOR:
+         WritePixel(target, tx, ty, GetBit(dst, tx) ^ !s);
+         break;
+      case kDrawModeInverted:
+         WritePixel(target, tx, ty, !s);
+         break;
+   }
+}
+
+static void HostDrawBitmap(LCDBitmap *bitmap, int x, int y, LCDBitmapFlip flip)
+{
+   LCDBitmap *target = Target();
+   for(int j = 0; j < bitmap->height; j++)
+   {
+      const int sy = (flip == kBitmapFlippedY || flip == kBitmapFlippedXY)
+                     ? bitmap->height - 1 - j : j;
+      for(int i = 0; i < bitmap->width; i++)
+      {
+         const int sx = (flip == kBitmapFlippedX || flip == kBitmapFlippedXY)
+                        ? bitmap->width - 1 - i : i;
+         DrawBitmapPixel(target, bitmap, sx, sy, x + i, y + j);
+      }
+   }
+}
+
+// Scaling uses nearest neighbor sampling, and negative scales flip the
+// bitmap.
+static void HostDrawScaledBitmap(LCDBitmap *bitmap, int x, int y,
+                                 float xscale, float yscale)
+{
+   LCDBitmap *target = Target();
+   const int width = (int)(bitmap->width * fabsf(xscale));
+   const int height = (int)(bitmap->height * fabsf(yscale));
+   for(int j = 0; j < height; j++)
+   {
+      int sy = (int)(j / fabsf(yscale));
+      if( sy >= bitmap->height ) { sy = bitmap->height - 1; }
+      if( yscale < 0 ) { sy = bitmap->height - 1 - sy; }
+      for(int i = 0; i < width; i++)
+      {
+         int sx = (int)(i / fabsf(xscale));
+         if( sx >= bitmap->width ) { sx = bitmap->width - 1; }
+         if( xscale < 0 ) { sx = bitmap->width - 1 - sx; }
+         DrawBitmapPixel(target, bitmap, sx, sy, x + i, y + j);
+      }
+   }
+}
+
+// Rotation is clockwise in degrees around the point (centerx, centery),
+// given as a fraction of bitmap size, which is placed at (x, y).  Each
+// target pixel within reach of the bitmap is mapped back to the nearest
+// bitmap pixel.
+static void HostDrawRotatedBitmap(LCDBitmap *bitmap, int x, int y,
+                                  float rotation,
+                                  float centerx, float centery,
+                                  float xscale, float yscale)
+{
+   LCDBitmap *target = Target();
+   const float radians = rotation * 3.14159265f / 180.0f;
+   const float c = cosf(radians);
+   const float s = sinf(radians);
+   const int reach = (int)ceilf(hypotf(bitmap->width * xscale,
+                                       bitmap->height * yscale));
+   for(int ty = y - reach; ty <= y + reach; ty++)
+   {
+      for(int tx = x - reach; tx <= x + reach; tx++)
+      {
+         const float dx = tx + 0.5f - x;
+         const float dy = ty + 0.5f - y;
+         const int sx = (int)floorf((dx * c + dy * s) / xscale +
+                                    centerx * bitmap->width);
+         const int sy = (int)floorf((dy * c - dx * s) / yscale +
+                                    centery * bitmap->height);
+         if( sx >= 0 && sx < bitmap->width && sy >= 0 && sy < bitmap->height )
+            DrawBitmapPixel(target, bitmap, sx, sy, tx, ty);
+      }
+   }
+}
+
+static void HostSetStencilImage(LCDBitmap *stencil, int tile)
+{
+   g_stencil = stencil;
+   g_stencil_tiled = tile;
+}
+
+static void HostSetStencil(LCDBitmap *stencil)
+{
+   HostSetStencilImage(stencil, 0);
+}
+
+static int HostDrawText(const void *text, size_t length,
+                        PDStringEncoding encoding, int x, int y)
+{
+   // Text is not rendered.
+   return 0;
+}
+
+static LCDBitmap *HostNewBitmap(int width, int height, LCDColor bgcolor)
+{
+   LCDBitmap *bitmap = malloc(sizeof(LCDBitmap));
+   bitmap->width = width;
+   bitmap->height = height;
+   bitmap->rowbytes = (width + 31) / 32 * 4;
+   bitmap->data = calloc(bitmap->rowbytes * height, 1);
+   bitmap->mask = NULL;
+   if( bgcolor == kColorClear )
+   {
+      bitmap->mask = calloc(bitmap->rowbytes * height, 1);
+   }
+   else
+   {
+      HostPushContext(bitmap);
+      HostClear(bgcolor);
+      HostPopContext();
+   }
+   return bitmap;
+}
+
+static void HostFreeBitmap(LCDBitmap *bitmap)
+{
+   if( bitmap == NULL )
+      return;
+   free(bitmap->data);
+   free(bitmap->mask);
+   free(bitmap);
+}
+
+static void HostGetBitmapData(LCDBitmap *bitmap,
+                              int *width, int *height, int *rowbytes,
+                              uint8_t **mask, uint8_t **data)
+{
+   if( width != NULL ) { *width = bitmap->width; }
+   if( height != NULL ) { *height = bitmap->height; }
+   if( rowbytes != NULL ) { *rowbytes = bitmap->rowbytes; }
+   if( mask != NULL ) { *mask = bitmap->mask; }
+   if( data != NULL ) { *data = bitmap->data; }
+}
+
+static void HostClearBitmap(LCDBitmap *bitmap, LCDColor bgcolor)
+{
+   HostPushContext(bitmap);
+   HostClear(bgcolor);
+   HostPopContext();
+}
+
+static uint8_t *HostGetFrame(void)
+{
+   return g_frame;
+}
+
+static uint8_t *HostGetDisplayFrame(void)
+{
+   return g_display_frame;
+}
+
+static void HostMarkUpdatedRows(int start, int end)
+{
+   if( start < 0 ) { start = 0; }
+   if( end >= LCD_ROWS ) { end = LCD_ROWS - 1; }
+   for(int y = start; y <= end; y++)
+      g_updated_rows[y] = 1;
+}
+
+static void HostDisplay(void)
+{
+}
+
+static void HostSetPixel(int x, int y, LCDColor color)
+{
+   ApplyColor(Target(), x, y, color);
+}
+
+// Return nonzero if pixel (x, y) of bitmap is opaque.
+static int IsOpaque(const LCDBitmap *bitmap, int x, int y, LCDBitmapFlip flip)
+{
+   if( flip == kBitmapFlippedX || flip == kBitmapFlippedXY )
+      x = bitmap->width - 1 - x;
+   if( flip == kBitmapFlippedY || flip == kBitmapFlippedXY )
+      y = bitmap->height - 1 - y;
+   return bitmap->mask == NULL ||
+          GetBit(bitmap->mask + y * bitmap->rowbytes, x) != 0;
+}
+
+static int HostCheckMaskCollision(LCDBitmap *bitmap1, int x1, int y1,
+                                  LCDBitmapFlip flip1,
+                                  LCDBitmap *bitmap2, int x2, int y2,
+                                  LCDBitmapFlip flip2,
+                                  LCDRect rect)
+{
+   // Intersection of both bitmaps and rect.
+   int left = x1 > x2 ? x1 : x2;
+   int top = y1 > y2 ? y1 : y2;
+   int right = x1 + bitmap1->width < x2 + bitmap2->width
+               ? x1 + bitmap1->width : x2 + bitmap2->width;
+   int bottom = y1 + bitmap1->height < y2 + bitmap2->height
+                ? y1 + bitmap1->height : y2 + bitmap2->height;
+   if( left < rect.left ) { left = rect.left; }
+   if( top < rect.top ) { top = rect.top; }
+   if( right > rect.right ) { right = rect.right; }
+   if( bottom > rect.bottom ) { bottom = rect.bottom; }
+
+   for(int y = top; y < bottom; y++)
+   {
+      for(int x = left; x < right; x++)
+      {
+         if( IsOpaque(bitmap1, x - x1, y - y1, flip1) &&
+             IsOpaque(bitmap2, x - x2, y - y2, flip2) )
+         {
+            return 1;
+         }
+      }
+   }
+   return 0;
+}
+
+static void HostSetClipRect(int x, int y, int width, int height)
+{
+   g_clip = LCDMakeRect(x, y, width, height);
+}
+
+static void HostClearClipRect(void)
+{
+   g_clip = LCDMakeRect(0, 0, LCD_COLUMNS, LCD_ROWS);
+}
+
+// Bitmap tables are arrays of bitmaps of the same size.
+struct LCDBitmapTable
+{
+   LCDBitmap **bitmaps;
+   int count;
+};
+
+static LCDBitmapTable *HostNewBitmapTable(int count, int width, int height)
+{
+   LCDBitmapTable *table = malloc(sizeof(LCDBitmapTable));
+   table->bitmaps = malloc(count * sizeof(LCDBitmap*));
+   table->count = count;
+   for(int i = 0; i < count; i++)
+      table->bitmaps[i] = HostNewBitmap(width, height, kColorWhite);
+   return table;
+}
+
+static void HostFreeBitmapTable(LCDBitmapTable *table)
+{
+   if( table == NULL )
+      return;
+   for(int i = 0; i < table->count; i++)
+      HostFreeBitmap(table->bitmaps[i]);
+   free(table->bitmaps);
+   free(table);
+}
+
+static LCDBitmap *HostGetTableBitmap(LCDBitmapTable *table, int index)
+{
+   return index >= 0 && index < table->count ? table->bitmaps[index] : NULL;
+}
+
+static void HostSetBackgroundColor(LCDSolidColor color)
+{
+   g_background_color = color;
+}
+
+// playdate->graphics->tilemap functions.  Tilemaps draw each tile with
+// drawBitmap, skipping tiles that are entirely off screen.
+
+struct LCDTileMap
+{
+   LCDBitmapTable *table;
+   uint16_t *tiles;
+   int columns, rows;
+};
+
+static LCDTileMap *HostNewTilemap(void)
+{
+   return calloc(1, sizeof(LCDTileMap));
+}
+
+static void HostFreeTilemap(LCDTileMap *map)
+{
+   if( map == NULL )
+      return;
+   free(map->tiles);
+   free(map);
+}
+
+static void HostSetImageTable(LCDTileMap *map, LCDBitmapTable *table)
+{
+   map->table = table;
+}
+
+static void HostSetTilemapSize(LCDTileMap *map, int columns, int rows)
+{
+   free(map->tiles);
+   map->tiles = calloc(columns * rows, sizeof(uint16_t));
+   map->columns = columns;
+   map->rows = rows;
+}
+
+static void HostSetTiles(LCDTileMap *map, uint16_t *indexes, int count,
+                         int rowwidth)
+{
+   for(int i = 0; i < count; i++)
+   {
+      const int column = i % rowwidth;
+      const int row = i / rowwidth;
+      if( column < map->columns && row < map->rows )
+         map->tiles[row * map->columns + column] = indexes[i];
+   }
+}
+
+static void HostDrawTilemap(LCDTileMap *map, float x, float y)
+{
+   if( map->table == NULL || map->table->count == 0 )
+      return;
+   const LCDBitmap *first = map->table->bitmaps[0];
+   const int width = first->width;
+   const int height = first->height;
+   for(int row = 0; row < map->rows; row++)
+   {
+      const int ty = (int)y + row * height;
+      if( ty + height <= 0 || ty >= LCD_ROWS )
+         continue;
+      for(int column = 0; column < map->columns; column++)
+      {
+         const int tx = (int)x + column * width;
+         if( tx + width <= 0 || tx >= LCD_COLUMNS )
+            continue;
+         LCDBitmap *tile = HostGetTableBitmap(
+            map->table, map->tiles[row * map->columns + column]);
+         if( tile != NULL )
+            HostDrawBitmap(tile, tx, ty, kBitmapUnflipped);
+      }
+   }
+}
+
+static const struct playdate_tilemap kHostTilemap =
+{
+   .newTilemap = HostNewTilemap,
+   .freeTilemap = HostFreeTilemap,
+   .setImageTable = HostSetImageTable,
+   .setSize = HostSetTilemapSize,
+   .setTiles = HostSetTiles,
+   .drawAtPoint = HostDrawTilemap,
+};
+
+static const struct playdate_graphics kHostGraphics =
+{
+   .clear = HostClear,
+   .setDrawMode = HostSetDrawMode,
+   .pushContext = HostPushContext,
+   .popContext = HostPopContext,
+   .drawBitmap = HostDrawBitmap,
+   .drawScaledBitmap = HostDrawScaledBitmap,
+   .drawRotatedBitmap = HostDrawRotatedBitmap,
+   .setStencil = HostSetStencil,
+   .setStencilImage = HostSetStencilImage,
+   .fillRect = HostFillRect,
+   .drawText = HostDrawText,
+   .newBitmap = HostNewBitmap,
+   .freeBitmap = HostFreeBitmap,
+   .getBitmapData = HostGetBitmapData,
+   .clearBitmap = HostClearBitmap,
+   .getFrame = HostGetFrame,
+   .getDisplayFrame = HostGetDisplayFrame,
+   .markUpdatedRows = HostMarkUpdatedRows,
+   .display = HostDisplay,
+   .setPixel = HostSetPixel,
+   .setBackgroundColor = HostSetBackgroundColor,
+   .checkMaskCollision = HostCheckMaskCollision,
+   .setClipRect = HostSetClipRect,
+   .clearClipRect = HostClearClipRect,
+   .newBitmapTable = HostNewBitmapTable,
+   .freeBitmapTable = HostFreeBitmapTable,
+   .getTableBitmap = HostGetTableBitmap,
+   .tilemap = &kHostTilemap,
+};
+
+// playdate->sprite functions.
+//
+// Sprites are drawn in the order they were added, and all dirty areas in
+// a frame are merged into a single bounding box.  This is simpler than
+// the device, but draws the same pixels for sprites that do not overlap.
+
+struct LCDSprite
+{
+   LCDBitmap *image;
+   LCDBitmapFlip flip;
+   LCDBitmapDrawMode mode;
+
+   // Position and center, center is relative to sprite size.
+   float x, y, cx, cy;
+
+   // Sprite size, set from image or setSize.
+   float width, height;
+
+   // Collision rectangle relative to top left corner, and nonzero if it
+   // has been set.
+   PDRect collide_rect;
+   int has_collide_rect;
+
+   int visible;
+
+   // Nonzero if sprite is in display list.
+   int added;
+
+   // Nonzero if sprite needs to be redrawn.
+   int dirty;
+
+   // Area covered by sprite when it was last drawn, empty if it was not
+   // drawn.
+   LCDRect drawn;
+};
+
+// Display list.
+static LCDSprite **g_sprites = NULL;
+static int g_sprite_count = 0;
+static int g_sprite_capacity = 0;
+
+// Area to be redrawn in next updateAndDrawSprites call.
+static LCDRect g_dirty = {0, 0, 0, 0};
+
+static int IsEmptyRect(LCDRect r)
+{
+   return r.left >= r.right || r.top >= r.bottom;
+}
+
+// Expand dirty area to include "r".
+static void AddDirtyArea(LCDRect r)
+{
+   if( IsEmptyRect(r) )
+      return;
+   if( IsEmptyRect(g_dirty) )
+   {
+      g_dirty = r;
+      return;
+   }
+   if( g_dirty.left > r.left ) { g_dirty.left = r.left; }
+   if( g_dirty.right < r.right ) { g_dirty.right = r.right; }
+   if( g_dirty.top > r.top ) { g_dirty.top = r.top; }
+   if( g_dirty.bottom < r.bottom ) { g_dirty.bottom = r.bottom; }
+}
+
+// Return area covered by sprite at its current position.
+static LCDRect GetSpriteRect(const LCDSprite *sprite)
+{
+   if( sprite->image == NULL || sprite->visible == 0 )
+      return LCDMakeRect(0, 0, 0, 0);
+   return LCDMakeRect((int)floorf(sprite->x - sprite->cx * sprite->width),
+                      (int)floorf(sprite->y - sprite->cy * sprite->height),
+                      (int)sprite->width, (int)sprite->height);
+}
+
+static void HostAddDirtyRect(LCDRect rect)
+{
+   AddDirtyArea(rect);
+}
+
+static LCDSprite *HostNewSprite(void)
+{
+   LCDSprite *sprite = calloc(1, sizeof(LCDSprite));
+   sprite->cx = sprite->cy = 0.5f;
+   sprite->visible = 1;
+   return sprite;
+}
+
+static void HostRemoveSprite(LCDSprite *sprite)
+{
+   if( sprite->added == 0 )
+      return;
+   for(int i = 0; i < g_sprite_count; i++)
+   {
+      if( g_sprites[i] == sprite )
+      {
+         memmove(g_sprites + i, g_sprites + i + 1,
+                 (g_sprite_count - i - 1) * sizeof(LCDSprite*));
+         g_sprite_count--;
+         break;
+      }
+   }
+   sprite->added = 0;
+   AddDirtyArea(sprite->drawn);
+   sprite->drawn = LCDMakeRect(0, 0, 0, 0);
+}
+
+static void HostFreeSprite(LCDSprite *sprite)
+{
+   if( sprite == NULL )
+      return;
+   HostRemoveSprite(sprite);
+   free(sprite);
+}
+
+static void HostAddSprite(LCDSprite *sprite)
+{
+   if( sprite->added != 0 )
+      return;
+   if( g_sprite_count >= g_sprite_capacity )
+   {
+      g_sprite_capacity = g_sprite_capacity > 0 ? g_sprite_capacity * 2 : 64;
+      g_sprites = realloc(g_sprites, g_sprite_capacity * sizeof(LCDSprite*));
+   }
+   g_sprites[g_sprite_count++] = sprite;
+   sprite->added = 1;
+   sprite->dirty = 1;
+}
+
+static int HostGetSpriteCount(void)
+{
+   return g_sprite_count;
+}
+
+static void HostMoveTo(LCDSprite *sprite, float x, float y)
+{
+   if( sprite->x == x && sprite->y == y )
+      return;
+   sprite->x = x;
+   sprite->y = y;
+   sprite->dirty = 1;
+}
+
+static void HostSetImage(LCDSprite *sprite,
+                         LCDBitmap *image,
+                         LCDBitmapFlip flip)
+{
+   sprite->image = image;
+   sprite->flip = flip;
+   sprite->width = image != NULL ? image->width : 0;
+   sprite->height = image != NULL ? image->height : 0;
+   sprite->dirty = 1;
+}
+
+static void HostSetSpriteDrawMode(LCDSprite *sprite, LCDBitmapDrawMode mode)
+{
+   sprite->mode = mode;
+   sprite->dirty = 1;
+}
+
+static void HostSetCenter(LCDSprite *sprite, float x, float y)
+{
+   sprite->cx = x;
+   sprite->cy = y;
+   sprite->dirty = 1;
+}
+
+static void HostSetSize(LCDSprite *sprite, float width, float height)
+{
+   sprite->width = width;
+   sprite->height = height;
+   sprite->dirty = 1;
+}
+
+static void HostSetVisible(LCDSprite *sprite, int flag)
+{
+   sprite->visible = flag;
+   sprite->dirty = 1;
+}
+
+static void HostSetCollideRect(LCDSprite *sprite, PDRect collide_rect)
+{
+   sprite->collide_rect = collide_rect;
+   sprite->has_collide_rect = 1;
+}
+
+// Get collision rectangle in screen coordinates, returns 0 if sprite
+// does not collide.
+static int GetCollideRect(const LCDSprite *sprite, PDRect *rect)
+{
+   if( sprite->has_collide_rect == 0 )
+      return 0;
+   *rect = sprite->collide_rect;
+   rect->x += sprite->x - sprite->cx * sprite->width;
+   rect->y += sprite->y - sprite->cy * sprite->height;
+   return 1;
+}
+
+// Return all overlapping pairs by testing every pair of sprites.
+static LCDSprite **HostAllOverlappingSprites(int *len)
+{
+   LCDSprite **pairs = NULL;
+   int count = 0;
+   int capacity = 0;
+   for(int i = 0; i < g_sprite_count; i++)
+   {
+      PDRect a;
+      if( GetCollideRect(g_sprites[i], &a) == 0 )
+         continue;
+      for(int j = i + 1; j < g_sprite_count; j++)
+      {
+         PDRect b;
+         if( GetCollideRect(g_sprites[j], &b) == 0 ||
+             a.x >= b.x + b.width || b.x >= a.x + a.width ||
+             a.y >= b.y + b.height || b.y >= a.y + a.height )
+         {
+            continue;
+         }
+         if( count + 2 > capacity )
+         {
+            capacity = capacity > 0 ? capacity * 2 : 64;
+            pairs = realloc(pairs, capacity * sizeof(LCDSprite*));
+         }
+         pairs[count++] = g_sprites[i];
+         pairs[count++] = g_sprites[j];
+      }
+   }
+   *len = count;
+   return pairs;
+}
+
+static void HostUpdateAndDrawSprites(void)
+{
+   for(int i = 0; i < g_sprite_count; i++)
+   {
+      LCDSprite *sprite = g_sprites[i];
+      if( sprite->dirty == 0 )
+         continue;
+      AddDirtyArea(sprite->drawn);
+      AddDirtyArea(GetSpriteRect(sprite));
+   }
+   if( g_dirty.left < 0 ) { g_dirty.left = 0; }
+   if( g_dirty.top < 0 ) { g_dirty.top = 0; }
+   if( g_dirty.right > LCD_COLUMNS ) { g_dirty.right = LCD_COLUMNS; }
+   if( g_dirty.bottom > LCD_ROWS ) { g_dirty.bottom = LCD_ROWS; }
+   if( IsEmptyRect(g_dirty) )
+      return;
+
+   HostPushContext(NULL);
+   HostFillRect(g_dirty.left, g_dirty.top,
+                g_dirty.right - g_dirty.left, g_dirty.bottom - g_dirty.top,
+                g_background_color);
+   const LCDBitmapDrawMode mode = g_draw_mode;
+   g_clip = g_dirty;
+   for(int i = 0; i < g_sprite_count; i++)
+   {
+      LCDSprite *sprite = g_sprites[i];
+      const LCDRect r = GetSpriteRect(sprite);
+      sprite->drawn = r;
+      sprite->dirty = 0;
+      if( IsEmptyRect(r) || r.right <= g_dirty.left ||
+          r.left >= g_dirty.right || r.bottom <= g_dirty.top ||
+          r.top >= g_dirty.bottom )
+      {
+         continue;
+      }
+      g_draw_mode = sprite->mode;
+      HostDrawBitmap(sprite->image, r.left, r.top, sprite->flip);
+   }
+   g_clip = LCDMakeRect(0, 0, LCD_COLUMNS, LCD_ROWS);
+   g_draw_mode = mode;
+   HostPopContext();
+
+   // Drawing marks updated rows on the device.
+   HostMarkUpdatedRows(g_dirty.top, g_dirty.bottom - 1);
+   g_dirty = LCDMakeRect(0, 0, 0, 0);
+}
+
+static const struct playdate_sprite kHostSprite =
+{
+   .addDirtyRect = HostAddDirtyRect,
+   .updateAndDrawSprites = HostUpdateAndDrawSprites,
+   .newSprite = HostNewSprite,
+   .freeSprite = HostFreeSprite,
+   .addSprite = HostAddSprite,
+   .removeSprite = HostRemoveSprite,
+   .getSpriteCount = HostGetSpriteCount,
+   .moveTo = HostMoveTo,
+   .setImage = HostSetImage,
+   .setDrawMode = HostSetSpriteDrawMode,
+   .setCenter = HostSetCenter,
+   .setSize = HostSetSize,
+   .setVisible = HostSetVisible,
+   .setCollideRect = HostSetCollideRect,
+   .allOverlappingSprites = HostAllOverlappingSprites,
+};
+
+// playdate->display functions.
+
+static int HostGetWidth(void)
+{
+   return LCD_COLUMNS;
+}
+
+static int HostGetHeight(void)
+{
+   return LCD_ROWS;
+}
+
+static void HostSetRefreshRate(float rate)
+{
+}
+
+static float HostGetFPS(void)
+{
+   return g_fps;
+}
+
+static const struct playdate_display kHostDisplay =
+{
+   .getWidth = HostGetWidth,
+   .getHeight = HostGetHeight,
+   .setRefreshRate = HostSetRefreshRate,
+   .getFPS = HostGetFPS,
+};
+
+// Exported functions.
+PlaydateAPI *GetHostAPI(void)
+{
+   static PlaydateAPI api =
+   {
+      .system = &kHostSystem,
+      .graphics = &kHostGraphics,
+      .sprite = &kHostSprite,
+      .display = &kHostDisplay,
+   };
+   return &api;
+}
+
+void EndHostFrame(void)
+{
+   // Flush updated rows.
+   g_updated_row_count = 0;
+   for(int y = 0; y < LCD_ROWS; y++)
+   {
+      if( g_updated_rows[y] == 0 )
+         continue;
+      memcpy(g_display_frame + y * LCD_ROWSIZE,
+             g_frame + y * LCD_ROWSIZE,
+             LCD_ROWSIZE);
+      g_updated_rows[y] = 0;
+      g_updated_row_count++;
+   }
+
+   // Update frame rate.  Like the device, this is a smoothed value.
+   const double now = Now();
+   if( g_last_frame_time > 0 && now > g_last_frame_time )
+   {
+      const float fps = (float)(1.0 / (now - g_last_frame_time));
+      g_fps = g_fps > 0 ? g_fps * 0.9f + fps * 0.1f : fps;
+   }
+   g_last_frame_time = now;
+}
+
+int GetHostUpdatedRowCount(void)
+{
+   return g_updated_row_count;
+}
@@ -0,0 +1,21 @@
+// Stub PlaydateAPI for running benchmarks on the host.
+//
+// Graphics calls draw to a software framebuffer using the same 1-bit
+// layout as the device, so that drawing costs are roughly proportional
+// to device costs.  Functions not used by any benchmark are left NULL.
+
+#ifndef HOST_API_H_
+#define HOST_API_H_
+
+#include"pd_api.h"
+
+// Return pointer to stub API.
+PlaydateAPI *GetHostAPI(void);
+
+// Mark end of a frame.  This updates the value returned by getFPS.
+void EndHostFrame(void);
+
+// Return number of rows marked by markUpdatedRows since last EndHostFrame.
+int GetHostUpdatedRowCount(void);
+
+#endif  // HOST_API_H_
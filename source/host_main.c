@@ -0,0 +1,374 @@
+// Command line runner for benchmarks, using the stub API from host_api.c.
+//
+// Usage:
+//
+//   pdbench [-f frames] [-w warmup_frames] benchmark [name=value ...]
+//   pdbench -l
+//
+// Runs the selected benchmark for some number of frames with the given
+// parameters, and prints the average cost per frame and per operation.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<unistd.h>
+
+#include"host_api.h"
+#include"arith.h"
+#include"fixed.h"
+#include"latency.h"
+#include"simd.h"
+#include"mathfn.h"
+#include"double.h"
+#include"memory.h"
+#include"bandwidth.h"
+#include"chase.h"
+#include"region.h"
+#include"alloc.h"
+#include"layout.h"
+#include"access.h"
+#include"collision.h"
+#include"bitmap.h"
+#include"scroll.h"
+#include"fill.h"
+#include"sprite.h"
+#include"screen.h"
+#include"timer.h"
+
+// Default number of frames.
+#define DEFAULT_FRAME_COUNT   100
+#define DEFAULT_WARMUP_COUNT  10
+
+typedef struct
+{
+   // Benchmark name, same as the names in the "test" menu.
+   const char *name;
+
+   // Run a single frame of benchmark.
+   void (*run)(PlaydateAPI *pd, int full_refresh);
+
+   // Adjustable parameters.
+   const BenchmarkParam *params;
+} Benchmark;
+
+static void RunArithmeticBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   ArithmeticBenchmark(pd, 0, full_refresh);
+}
+
+static void RunFixedPointBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   FixedPointBenchmark(pd, 0, full_refresh);
+}
+
+static void RunIntLatencyBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   IntLatencyBenchmark(pd, 0, full_refresh);
+}
+
+static void RunFloatLatencyBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   FloatLatencyBenchmark(pd, 0, full_refresh);
+}
+
+static void RunSimdBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   SimdBenchmark(pd, 0, full_refresh);
+}
+
+static void RunTrigBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   TrigBenchmark(pd, 0, full_refresh);
+}
+
+static void RunSqrtExpBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   SqrtExpBenchmark(pd, 0, full_refresh);
+}
+
+static void RunDoubleBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   DoubleBenchmark(pd, 0, full_refresh);
+}
+
+static void RunMemoryBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   MemoryBenchmark(pd, 0, full_refresh);
+}
+
+static void RunBandwidthBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   BandwidthBenchmark(pd, 0, full_refresh);
+}
+
+static void RunChaseBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   ChaseBenchmark(pd, 0, full_refresh);
+}
+
+static void RunRegionBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   RegionBenchmark(pd, 0, full_refresh);
+}
+
+static void RunAllocBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   AllocBenchmark(pd, 0, full_refresh);
+}
+
+static void RunLayoutBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   LayoutBenchmark(pd, 0, full_refresh);
+}
+
+static void RunAccessBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   AccessBenchmark(pd, 0, full_refresh);
+}
+
+static void RunCollisionBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   CollisionBenchmark(pd, 0, full_refresh);
+}
+
+static void RunBitmapBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   BitmapBenchmark(pd, 0, full_refresh);
+}
+
+static void RunScrollBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   ScrollBenchmark(pd, 0, full_refresh);
+}
+
+static void RunFillBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   FillBenchmark(pd, 0, full_refresh);
+}
+
+static void RunSpriteBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   SpriteBenchmark(pd, 0, full_refresh);
+}
+
+static void RunScreenBenchmark(PlaydateAPI *pd, int full_refresh)
+{
+   ScreenBenchmark(pd, 0, full_refresh);
+}
+
+static const Benchmark kBenchmarks[] =
+{
+   {"math", RunArithmeticBenchmark, kArithmeticParams},
+   {"fixed point", RunFixedPointBenchmark, kFixedPointParams},
+   {"int latency", RunIntLatencyBenchmark, kIntLatencyParams},
+   {"float latency", RunFloatLatencyBenchmark, kFloatLatencyParams},
+   {"simd", RunSimdBenchmark, kSimdParams},
+   {"trig", RunTrigBenchmark, kTrigParams},
+   {"sqrt exp", RunSqrtExpBenchmark, kSqrtExpParams},
+   {"double", RunDoubleBenchmark, kDoubleParams},
+   {"memory", RunMemoryBenchmark, kMemoryParams},
+   {"bandwidth", RunBandwidthBenchmark, kBandwidthParams},
+   {"chase", RunChaseBenchmark, kChaseParams},
+   {"region", RunRegionBenchmark, kRegionParams},
+   {"alloc", RunAllocBenchmark, kAllocParams},
+   {"layout", RunLayoutBenchmark, kLayoutParams},
+   {"access", RunAccessBenchmark, kAccessParams},
+   {"collision", RunCollisionBenchmark, kCollisionParams},
+   {"bitmap", RunBitmapBenchmark, kBitmapParams},
+   {"scroll", RunScrollBenchmark, kScrollParams},
+   {"fill", RunFillBenchmark, kFillParams},
+   {"sprites", RunSpriteBenchmark, kSpriteParams},
+   {"screen", RunScreenBenchmark, kScreenParams},
+   {NULL, NULL, NULL}
+};
+
+// Return monotonic time in seconds.
+static double Now(void)
+{
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// Print usage and list of benchmarks.
+static void Usage(const char *program)
+{
+   fprintf(stderr,
+           "%s [-f frames] [-w warmup_frames] benchmark [name=value ...]\n"
+           "%s -l\n\n"
+           "  -f: number of measured frames (default %d)\n"
+           "  -w: number of frames to run before measuring (default %d)\n"
+           "  -l: list benchmarks and parameters\n",
+           program, program, DEFAULT_FRAME_COUNT, DEFAULT_WARMUP_COUNT);
+}
+
+// List benchmarks and their parameters.
+static void ListBenchmarks(void)
+{
+   for(const Benchmark *b = kBenchmarks; b->name != NULL; b++)
+   {
+      printf("%s\n", b->name);
+      for(const BenchmarkParam *p = b->params; p->name != NULL; p++)
+      {
+         printf("  %s=%d  (%d..%d)\n", p->name, *p->value, p->min, p->max);
+      }
+   }
+}
+
+// Find benchmark by name, returns NULL if not found.
+static const Benchmark *FindBenchmark(const char *name)
+{
+   for(const Benchmark *b = kBenchmarks; b->name != NULL; b++)
+   {
+      if( strcmp(b->name, name) == 0 )
+         return b;
+   }
+   return NULL;
+}
+
+// Apply a single "name=value" setting, returns 0 on success.
+static int SetParam(const Benchmark *b, const char *setting)
+{
+   const char *separator = strchr(setting, '=');
+   if( separator == NULL )
+   {
+      fprintf(stderr, "%s: expected name=value\n", setting);
+      return 1;
+   }
+   const size_t length = separator - setting;
+   for(const BenchmarkParam *p = b->params; p->name != NULL; p++)
+   {
+      if( strlen(p->name) != length || strncmp(p->name, setting, length) != 0 )
+         continue;
+
+      char *end;
+      const long value = strtol(separator + 1, &end, 0);
+      if( *end != '\0' || end == separator + 1 )
+      {
+         fprintf(stderr, "%s: invalid value\n", setting);
+         return 1;
+      }
+      if( value < p->min || value > p->max )
+      {
+         fprintf(stderr, "%s: value out of range (%d..%d)\n",
+                 setting, p->min, p->max);
+         return 1;
+      }
+      *p->value = (int)value;
+      return 0;
+   }
+   fprintf(stderr, "%s: unknown parameter for %s\n", setting, b->name);
+   return 1;
+}
+
+// Run benchmark and print results.
+static void Run(const Benchmark *b, int frame_count, int warmup_count)
+{
+   PlaydateAPI *pd = GetHostAPI();
+
+   // Use fixed random seed for reproducible sprite positions.
+   srand(1);
+
+   for(int i = 0; i < warmup_count; i++)
+   {
+      b->run(pd, i == 0);
+      EndHostFrame();
+   }
+
+   double total = 0;
+   double min_time = 0, max_time = 0;
+   long long rows = 0;
+   for(int i = 0; i < frame_count; i++)
+   {
+      const double start = Now();
+      b->run(pd, warmup_count == 0 && i == 0);
+      const double t = Now() - start;
+      EndHostFrame();
+
+      total += t;
+      if( i == 0 || t < min_time ) { min_time = t; }
+      if( i == 0 || t > max_time ) { max_time = t; }
+      rows += GetHostUpdatedRowCount();
+   }
+
+   long long ops = 0;
+   printf("benchmark: %s\n", b->name);
+   for(const BenchmarkParam *p = b->params; p->name != NULL; p++)
+   {
+      printf("%s: %d\n", p->name, *p->value);
+      if( p->is_count )
+         ops += *p->value;
+   }
+   for(const BenchmarkParam *p = b->params; p->name != NULL; p++)
+   {
+      if( p->cycles_per_op != NULL && *p->value > 0 )
+      {
+         printf("%s ns/op: %.3f\n",
+                p->name, (double)CyclesToNanoseconds(*p->cycles_per_op));
+      }
+   }
+
+   const double frame_time = total / frame_count;
+   printf("frames: %d\n"
+          "ms/frame: %.4f (min %.4f, max %.4f)\n"
+          "frames/s: %.1f\n"
+          "rows/frame: %.1f\n",
+          frame_count,
+          frame_time * 1e3, min_time * 1e3, max_time * 1e3,
+          1.0 / frame_time,
+          (double)rows / frame_count);
+   if( ops > 0 )
+   {
+      printf("ops/frame: %lld\n"
+             "ops/s: %.4g\n"
+             "ns/op: %.3f\n",
+             ops, ops / frame_time, frame_time * 1e9 / ops);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   int frame_count = DEFAULT_FRAME_COUNT;
+   int warmup_count = DEFAULT_WARMUP_COUNT;
+
+   int opt;
+   while( (opt = getopt(argc, argv, "f:w:l")) != -1 )
+   {
+      switch( opt )
+      {
+         case 'f':
+            frame_count = atoi(optarg);
+            break;
+         case 'w':
+            warmup_count = atoi(optarg);
+            break;
+         case 'l':
+            ListBenchmarks();
+            return EXIT_SUCCESS;
+         default:
+            Usage(argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+   if( optind >= argc || frame_count <= 0 || warmup_count < 0 )
+   {
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   const Benchmark *b = FindBenchmark(argv[optind]);
+   if( b == NULL )
+   {
+      fprintf(stderr, "%s: unknown benchmark\n", argv[optind]);
+      return EXIT_FAILURE;
+   }
+   for(int i = optind + 1; i < argc; i++)
+   {
+      if( SetParam(b, argv[i]) != 0 )
+         return EXIT_FAILURE;
+   }
+
+   Run(b, frame_count, warmup_count);
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,222 @@
+#include"kernel.h"
+#include"timer.h"
+
+// Screen layout.  First line is frame rate, followed by one line per
+// kernel, followed by help text.
+#define LINE_HEIGHT  20
+#define KERNEL_Y     (5 + LINE_HEIGHT)
+#define HELP_Y       (KERNEL_Y + MAX_KERNELS * LINE_HEIGHT)
+
+// Degrees of crank movement for each step of a setting.
+#define SETTING_STEP_ANGLE  30
+
+// Number of iterations for measuring loop overhead.
+#define CALIBRATION_COUNT   0x1000
+
+// Measured cycles per iteration of an empty loop.  This is subtracted
+// from the costs of sets that list their operations per iteration, and
+// is displayed for reference otherwise.
+static float g_loop_cost = 0;
+
+// Run each kernel and record its cost.
+static void RunKernels(PlaydateAPI *pd, const KernelSet *set)
+{
+   UpdateLoopCost(pd, &g_loop_cost, CALIBRATION_COUNT);
+
+   for(int i = 0; i < MAX_KERNELS && set->params[i].name != NULL; i++)
+   {
+      const BenchmarkParam *p = set->params + i;
+      if( p->is_count == 0 )
+         continue;
+
+      // Each kernel is timed separately, so that the costs are not mixed
+      // with drawing and display updates.
+      const uint32_t t0 = GetTimestamp(pd);
+      set->kernels[i](*p->value);
+      const uint32_t t1 = GetTimestamp(pd);
+      UpdateCost(p->cycles_per_op, t1 - t0, *p->value);
+   }
+}
+
+// Return cost of a kernel in nanoseconds with loop overhead subtracted.
+static float NetNanoseconds(const KernelSet *set, int index)
+{
+   const float overhead = g_loop_cost / set->ops_per_iteration[index];
+   return CyclesToNanoseconds(
+      SubtractOverhead(*set->params[index].cycles_per_op, overhead));
+}
+
+// Draw frame rate, costs, and help text.
+static void DrawStatus(PlaydateAPI *pd, const KernelSet *set, int full_refresh)
+{
+   // Counts and costs are redrawn every frame, help text is only drawn
+   // on full refresh.
+   pd->graphics->fillRect(0, 0, LCD_COLUMNS,
+                          full_refresh != 0 ? HELP_Y + LINE_HEIGHT : HELP_Y,
+                          kColorWhite);
+
+   char *text = NULL;
+   int length = pd->system->formatString(
+      &text, "FPS = %.1f  (%s)  loop = %.2f ns",
+      (double)pd->display->getFPS(), set->title,
+      (double)CyclesToNanoseconds(g_loop_cost));
+   pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
+   pd->system->realloc(text, 0);
+
+   for(int i = 0; i < MAX_KERNELS && set->params[i].name != NULL; i++)
+   {
+      const BenchmarkParam *p = set->params + i;
+      if( p->is_count == 0 )
+      {
+         length = pd->system->formatString(
+            &text, "%s = %d", p->name, *p->value);
+      }
+      else if( set->extra != NULL && set->extra[i] >= 0 )
+      {
+         char *extra = NULL;
+         pd->system->formatString(
+            &extra,
+            set->extra_format != NULL ? set->extra_format : "error %.1e",
+            (double)set->extra[i]);
+         const float ns = CyclesToNanoseconds(*p->cycles_per_op);
+         if( set->show_frame_time != 0 )
+         {
+            length = pd->system->formatString(
+               &text, "%s = %d: %.2f ns, %.2f ms/frame, %s",
+               p->name, *p->value, (double)ns,
+               (double)(ns * *p->value * 1e-6f), extra);
+         }
+         else
+         {
+            length = pd->system->formatString(
+               &text, "%s = %d: %.2f ns, %s",
+               p->name, *p->value, (double)ns, extra);
+         }
+         pd->system->realloc(extra, 0);
+      }
+      else if( set->count_is_bytes != 0 )
+      {
+         // One byte per nanosecond is 1000 MB/s.
+         const float ns = CyclesToNanoseconds(*p->cycles_per_op);
+         length = pd->system->formatString(
+            &text, "%s = %d: %.1f MB/s",
+            p->name, *p->value, (double)(ns > 0 ? 1000.0f / ns : 0.0f));
+      }
+      else if( set->ops_per_iteration != NULL )
+      {
+         length = pd->system->formatString(
+            &text, "%s = %d: %.2f (net %.2f) ns, %.2f cycles",
+            p->name, *p->value,
+            (double)CyclesToNanoseconds(*p->cycles_per_op),
+            (double)NetNanoseconds(set, i),
+            (double)*p->cycles_per_op);
+      }
+      else
+      {
+         length = pd->system->formatString(
+            &text, "%s = %d: %.2f ns, %.2f cycles",
+            p->name, *p->value,
+            (double)CyclesToNanoseconds(*p->cycles_per_op),
+            (double)*p->cycles_per_op);
+      }
+      pd->graphics->drawText(text, length, kUTF8Encoding,
+                             5, KERNEL_Y + i * LINE_HEIGHT);
+      pd->system->realloc(text, 0);
+   }
+
+   if( full_refresh != 0 )
+   {
+      static const char kHelp[] =
+         /* Up/Down */ "\u2b06\u2b07: select, crank: adjust, "
+         /* A */       "\u24b6 + crank: all";
+      pd->graphics->drawText(kHelp, sizeof(kHelp) - 1, kUTF8Encoding,
+                             5, HELP_Y);
+   }
+}
+
+// Apply adjustment to a single parameter, clamping results to bounds.
+static void AdjustOp(const BenchmarkParam *p, int delta)
+{
+   *p->value += delta;
+   if( *p->value < p->min ) { *p->value = p->min; }
+   if( *p->value > p->max ) { *p->value = p->max; }
+}
+
+// Handle user input.
+static void HandleInput(PlaydateAPI *pd,
+                        const KernelSet *set,
+                        PDButtons buttons)
+{
+   KernelState *state = set->state;
+   const PDButtons pushed = buttons & ~state->previous_buttons;
+   state->previous_buttons = buttons;
+
+   int count = 0;
+   while( count < MAX_KERNELS && set->params[count].name != NULL )
+      count++;
+   if( (pushed & kButtonUp) != 0 && state->selected > 0 )
+      state->selected--;
+   if( (pushed & kButtonDown) != 0 && state->selected < count - 1 )
+      state->selected++;
+
+   const float crank = pd->system->getCrankChange();
+   const int delta = 100 * crank;
+   if( (buttons & (kButtonA | kButtonB)) != 0 )
+   {
+      // Adjust all operation counts, settings are left as is.
+      pd->graphics->fillRect(0, KERNEL_Y, LCD_COLUMNS, count * LINE_HEIGHT,
+                             kColorXOR);
+      for(int i = 0; i < count; i++)
+      {
+         if( set->params[i].is_count != 0 )
+            AdjustOp(set->params + i, delta);
+      }
+   }
+   else if( state->selected < count )
+   {
+      const BenchmarkParam *p = set->params + state->selected;
+      pd->graphics->fillRect(0, KERNEL_Y + state->selected * LINE_HEIGHT,
+                             LCD_COLUMNS, LINE_HEIGHT, kColorXOR);
+      if( p->is_count != 0 )
+      {
+         AdjustOp(p, delta);
+      }
+      else
+      {
+         // Settings have few values, so they change by one step for
+         // every SETTING_STEP_ANGLE degrees.
+         state->crank_angle += crank;
+         const int steps = (int)(state->crank_angle / SETTING_STEP_ANGLE);
+         state->crank_angle -= steps * SETTING_STEP_ANGLE;
+         AdjustOp(p, steps);
+      }
+   }
+}
+
+// Exported functions.
+void KernelBenchmark(PlaydateAPI *pd,
+                     const KernelSet *set,
+                     PDButtons buttons,
+                     int full_refresh)
+{
+   RunKernels(pd, set);
+   DrawStatus(pd, set, full_refresh);
+   HandleInput(pd, set, buttons);
+
+   pd->graphics->markUpdatedRows(
+      5, (full_refresh != 0 ? HELP_Y + LINE_HEIGHT : HELP_Y) - 1);
+}
+
+void ResetKernelSet(const KernelSet *set, int count)
+{
+   for(const BenchmarkParam *p = set->params; p->name != NULL; p++)
+   {
+      if( p->is_count != 0 )
+      {
+         *p->value = count;
+         *p->cycles_per_op = 0;
+      }
+   }
+   set->state->selected = 0;
+   set->state->crank_angle = 0;
+}
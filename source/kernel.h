@@ -0,0 +1,86 @@
+// Shared driver for benchmarks that time a list of small kernels.
+//
+// arith.c and memory.c each have exactly four operations, one per
+// directional button.  Benchmarks with more operations than that use this
+// module instead: kernels are listed one per line with their measured
+// costs, up/down selects a kernel, and crank adjusts its count.
+//
+// Parameters that are not operation counts are settings shared by all
+// kernels, such as access width.  These are listed with the kernels but
+// have no kernel function of their own.
+
+#ifndef KERNEL_H_
+#define KERNEL_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+// Maximum number of kernels and settings that fit on screen.
+#define MAX_KERNELS  8
+
+// Run "count" operations of a single kernel.
+typedef void (*KernelFunction)(int count);
+
+typedef struct
+{
+   // Index of selected kernel.
+   int selected;
+
+   // Button state from previous frame, for detecting button presses.
+   PDButtons previous_buttons;
+
+   // Crank movement not yet applied to a setting, in degrees.
+   float crank_angle;
+} KernelState;
+
+typedef struct
+{
+   // Title shown next to the frame rate.
+   const char *title;
+
+   // Operation counts and settings, terminated by an entry with NULL
+   // name.  Operation counts should have cycles_per_op set.
+   const BenchmarkParam *params;
+
+   // Kernel functions, in the same order as params.  Entries for
+   // settings are NULL.
+   const KernelFunction *kernels;
+
+   // Extra value for each kernel, such as maximum error, in the same
+   // order as params.  If not NULL, nonnegative values are shown instead
+   // of cycles per operation.
+   const float *extra;
+
+   // If nonzero, operation counts are in bytes, and throughput is shown
+   // in MB/s instead of cycles per operation.
+   int count_is_bytes;
+
+   // UI state.
+   KernelState *state;
+
+   // Format for extra values, NULL for "error %.1e".  This and the
+   // fields below are last so that sets can leave them out.
+   const char *extra_format;
+
+   // Number of operations each kernel runs per loop iteration, in the
+   // same order as params.  If not NULL, the empty loop cost divided by
+   // this is subtracted to show a net cost for each kernel.
+   const int *ops_per_iteration;
+
+   // If nonzero, lines with extra values also show total time per frame,
+   // which is more useful than cost per operation for kernels whose cost
+   // per operation grows with count.
+   int show_frame_time;
+} KernelSet;
+
+// Run kernels and draw status.
+void KernelBenchmark(PlaydateAPI *pd,
+                     const KernelSet *set,
+                     PDButtons buttons,
+                     int full_refresh);
+
+// Set all operation counts to "count" and clear measurements.  Settings
+// are not changed.
+void ResetKernelSet(const KernelSet *set, int count);
+
+#endif  // KERNEL_H_
@@ -0,0 +1,213 @@
+#include"latency.h"
+#include"kernel.h"
+
+// Default operation counts.
+#define DEFAULT_OPERATION_COUNT  0x8000
+
+// Maximum operation count.
+#define MAX_COUNT                0xffffff
+
+// Operands and final results.  Unlike arith.c, only these are volatile,
+// and the accumulators are kept in registers.  Operands are read once
+// before each loop so that the compiler can not fold them into the
+// operations, and results are written once after each loop so that the
+// loops are not optimized away.
+static volatile uint32_t g_int_operand = 3;
+static volatile uint32_t g_int_result = 0;
+static volatile float g_float_operand = 1.0f;
+static volatile float g_float_result = 0;
+
+// Keep integer accumulator in a register without changing it.  Without
+// this, the compiler replaces a chain of additions with a single multiply.
+// Floating point chains do not need this since the compiler can not
+// reorder floating point operations without -ffast-math.
+#define KEEP(x)  __asm__("" : "+r"(x))
+
+// Operations.  Integer operations are unsigned so that overflow wraps.
+#define INT_ADD(a)    do { a += b; KEEP(a); } while(0)
+#define INT_MUL(a)    do { a *= b; KEEP(a); } while(0)
+#define FLOAT_ADD(a)  a += b
+#define FLOAT_MUL(a)  a *= b
+
+// Define kernels that run "count" operations spread across 1, 2, 4, or 8
+// independent accumulators.  Leftover operations when "count" is not a
+// multiple of the number of accumulators are run on the first one, so
+// that exactly "count" operations are run.
+#define DEFINE_KERNEL_1(name, type, operand, result, OP) \
+   static void name(int count) \
+   { \
+      const type b = operand; \
+      type a0 = b; \
+      for(int i = 0; i < count; i++) \
+      { \
+         OP(a0); \
+      } \
+      result = a0; \
+   }
+
+#define DEFINE_KERNEL_2(name, type, operand, result, OP) \
+   static void name(int count) \
+   { \
+      const type b = operand; \
+      type a0 = b, a1 = b; \
+      int i = 0; \
+      for(; i <= count - 2; i += 2) \
+      { \
+         OP(a0); OP(a1); \
+      } \
+      for(; i < count; i++) \
+      { \
+         OP(a0); \
+      } \
+      result = a0 + a1; \
+   }
+
+#define DEFINE_KERNEL_4(name, type, operand, result, OP) \
+   static void name(int count) \
+   { \
+      const type b = operand; \
+      type a0 = b, a1 = b, a2 = b, a3 = b; \
+      int i = 0; \
+      for(; i <= count - 4; i += 4) \
+      { \
+         OP(a0); OP(a1); OP(a2); OP(a3); \
+      } \
+      for(; i < count; i++) \
+      { \
+         OP(a0); \
+      } \
+      result = a0 + a1 + a2 + a3; \
+   }
+
+#define DEFINE_KERNEL_8(name, type, operand, result, OP) \
+   static void name(int count) \
+   { \
+      const type b = operand; \
+      type a0 = b, a1 = b, a2 = b, a3 = b, a4 = b, a5 = b, a6 = b, a7 = b; \
+      int i = 0; \
+      for(; i <= count - 8; i += 8) \
+      { \
+         OP(a0); OP(a1); OP(a2); OP(a3); OP(a4); OP(a5); OP(a6); OP(a7); \
+      } \
+      for(; i < count; i++) \
+      { \
+         OP(a0); \
+      } \
+      result = a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7; \
+   }
+
+DEFINE_KERNEL_1(IntAdd1, uint32_t, g_int_operand, g_int_result, INT_ADD)
+DEFINE_KERNEL_2(IntAdd2, uint32_t, g_int_operand, g_int_result, INT_ADD)
+DEFINE_KERNEL_4(IntAdd4, uint32_t, g_int_operand, g_int_result, INT_ADD)
+DEFINE_KERNEL_8(IntAdd8, uint32_t, g_int_operand, g_int_result, INT_ADD)
+DEFINE_KERNEL_1(IntMul1, uint32_t, g_int_operand, g_int_result, INT_MUL)
+DEFINE_KERNEL_2(IntMul2, uint32_t, g_int_operand, g_int_result, INT_MUL)
+DEFINE_KERNEL_4(IntMul4, uint32_t, g_int_operand, g_int_result, INT_MUL)
+DEFINE_KERNEL_8(IntMul8, uint32_t, g_int_operand, g_int_result, INT_MUL)
+DEFINE_KERNEL_1(FloatAdd1, float, g_float_operand, g_float_result, FLOAT_ADD)
+DEFINE_KERNEL_2(FloatAdd2, float, g_float_operand, g_float_result, FLOAT_ADD)
+DEFINE_KERNEL_4(FloatAdd4, float, g_float_operand, g_float_result, FLOAT_ADD)
+DEFINE_KERNEL_8(FloatAdd8, float, g_float_operand, g_float_result, FLOAT_ADD)
+DEFINE_KERNEL_1(FloatMul1, float, g_float_operand, g_float_result, FLOAT_MUL)
+DEFINE_KERNEL_2(FloatMul2, float, g_float_operand, g_float_result, FLOAT_MUL)
+DEFINE_KERNEL_4(FloatMul4, float, g_float_operand, g_float_result, FLOAT_MUL)
+DEFINE_KERNEL_8(FloatMul8, float, g_float_operand, g_float_result, FLOAT_MUL)
+
+// Integer operations.
+static int g_int_add_1 = DEFAULT_OPERATION_COUNT;
+static int g_int_add_2 = DEFAULT_OPERATION_COUNT;
+static int g_int_add_4 = DEFAULT_OPERATION_COUNT;
+static int g_int_add_8 = DEFAULT_OPERATION_COUNT;
+static int g_int_mul_1 = DEFAULT_OPERATION_COUNT;
+static int g_int_mul_2 = DEFAULT_OPERATION_COUNT;
+static int g_int_mul_4 = DEFAULT_OPERATION_COUNT;
+static int g_int_mul_8 = DEFAULT_OPERATION_COUNT;
+static float g_int_costs[8];
+
+const BenchmarkParam kIntLatencyParams[] =
+{
+   {"int_add_1", &g_int_add_1, 0, MAX_COUNT, 1, g_int_costs + 0},
+   {"int_add_2", &g_int_add_2, 0, MAX_COUNT, 1, g_int_costs + 1},
+   {"int_add_4", &g_int_add_4, 0, MAX_COUNT, 1, g_int_costs + 2},
+   {"int_add_8", &g_int_add_8, 0, MAX_COUNT, 1, g_int_costs + 3},
+   {"int_mul_1", &g_int_mul_1, 0, MAX_COUNT, 1, g_int_costs + 4},
+   {"int_mul_2", &g_int_mul_2, 0, MAX_COUNT, 1, g_int_costs + 5},
+   {"int_mul_4", &g_int_mul_4, 0, MAX_COUNT, 1, g_int_costs + 6},
+   {"int_mul_8", &g_int_mul_8, 0, MAX_COUNT, 1, g_int_costs + 7},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+static const KernelFunction kIntKernels[] =
+{
+   IntAdd1, IntAdd2, IntAdd4, IntAdd8, IntMul1, IntMul2, IntMul4, IntMul8
+};
+
+// Operations per loop iteration, the same for integer and floating point.
+static const int kOpsPerIteration[] = {1, 2, 4, 8, 1, 2, 4, 8};
+
+static KernelState g_int_state;
+
+static const KernelSet kIntKernelSet =
+{
+   "int latency", kIntLatencyParams, kIntKernels, NULL, 0, &g_int_state,
+   NULL, kOpsPerIteration
+};
+
+// Floating point operations.
+static int g_float_add_1 = DEFAULT_OPERATION_COUNT;
+static int g_float_add_2 = DEFAULT_OPERATION_COUNT;
+static int g_float_add_4 = DEFAULT_OPERATION_COUNT;
+static int g_float_add_8 = DEFAULT_OPERATION_COUNT;
+static int g_float_mul_1 = DEFAULT_OPERATION_COUNT;
+static int g_float_mul_2 = DEFAULT_OPERATION_COUNT;
+static int g_float_mul_4 = DEFAULT_OPERATION_COUNT;
+static int g_float_mul_8 = DEFAULT_OPERATION_COUNT;
+static float g_float_costs[8];
+
+const BenchmarkParam kFloatLatencyParams[] =
+{
+   {"float_add_1", &g_float_add_1, 0, MAX_COUNT, 1, g_float_costs + 0},
+   {"float_add_2", &g_float_add_2, 0, MAX_COUNT, 1, g_float_costs + 1},
+   {"float_add_4", &g_float_add_4, 0, MAX_COUNT, 1, g_float_costs + 2},
+   {"float_add_8", &g_float_add_8, 0, MAX_COUNT, 1, g_float_costs + 3},
+   {"float_mul_1", &g_float_mul_1, 0, MAX_COUNT, 1, g_float_costs + 4},
+   {"float_mul_2", &g_float_mul_2, 0, MAX_COUNT, 1, g_float_costs + 5},
+   {"float_mul_4", &g_float_mul_4, 0, MAX_COUNT, 1, g_float_costs + 6},
+   {"float_mul_8", &g_float_mul_8, 0, MAX_COUNT, 1, g_float_costs + 7},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+static const KernelFunction kFloatKernels[] =
+{
+   FloatAdd1, FloatAdd2, FloatAdd4, FloatAdd8,
+   FloatMul1, FloatMul2, FloatMul4, FloatMul8
+};
+
+static KernelState g_float_state;
+
+static const KernelSet kFloatKernelSet =
+{
+   "float latency", kFloatLatencyParams, kFloatKernels, NULL, 0,
+   &g_float_state, NULL, kOpsPerIteration
+};
+
+// Exported functions.
+void IntLatencyBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   KernelBenchmark(pd, &kIntKernelSet, buttons, full_refresh);
+}
+
+void ResetIntLatencyBenchmark(void)
+{
+   ResetKernelSet(&kIntKernelSet, DEFAULT_OPERATION_COUNT);
+}
+
+void FloatLatencyBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   KernelBenchmark(pd, &kFloatKernelSet, buttons, full_refresh);
+}
+
+void ResetFloatLatencyBenchmark(void)
+{
+   ResetKernelSet(&kFloatKernelSet, DEFAULT_OPERATION_COUNT);
+}
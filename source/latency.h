@@ -0,0 +1,24 @@
+// Benchmark for arithmetic latency versus throughput.
+//
+// Each operation is run with 1, 2, 4, and 8 independent accumulators.
+// With a single accumulator, each operation depends on the previous one,
+// so the cost per operation is the latency.  With more accumulators, the
+// cost per operation approaches the reciprocal throughput.
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void IntLatencyBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetIntLatencyBenchmark(void);
+
+void FloatLatencyBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetFloatLatencyBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kIntLatencyParams[];
+extern const BenchmarkParam kFloatLatencyParams[];
+
+#endif  // LATENCY_H_
@@ -0,0 +1,254 @@
+#include"layout.h"
+#include<stdint.h>
+#include<stdlib.h>
+#include"kernel.h"
+#include"sprite.h"
+
+// Default entity counts.
+#define DEFAULT_ENTITY_COUNT  1000
+
+// Bytes of data per entity that are not used by the update step, such as
+// sprite handles, animation state, and hit points.
+#define COLD_BYTES            24
+
+// Field types.
+enum
+{
+   kTypeInt32,
+   kTypeInt16,
+   kTypeFixed,
+
+   kTypeCount
+};
+
+// Number of fraction bits for fixed point fields.
+#define FIXED_SHIFT           16
+
+// Settings.
+static int g_type = kTypeInt32;
+
+// Number of entities updated.
+static int g_aos = DEFAULT_ENTITY_COUNT;
+static int g_aos_rand = DEFAULT_ENTITY_COUNT;
+static int g_soa = DEFAULT_ENTITY_COUNT;
+static int g_hot_cold = DEFAULT_ENTITY_COUNT;
+static float g_costs[4];
+
+const BenchmarkParam kLayoutParams[] =
+{
+   {"type",     &g_type,     0, kTypeCount - 1, 0, NULL},
+   {"aos",      &g_aos,      0, MAX_SPRITES,    1, g_costs + 0},
+   {"aos_rand", &g_aos_rand, 0, MAX_SPRITES,    1, g_costs + 1},
+   {"soa",      &g_soa,      0, MAX_SPRITES,    1, g_costs + 2},
+   {"hot_cold", &g_hot_cold, 0, MAX_SPRITES,    1, g_costs + 3},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Layouts for each field type.  Fixed point uses the same layouts as
+// int32.
+//
+// With hot/cold split, cold data lives in a separate array that is not
+// touched by the update step, so only the hot array is allocated here.
+#define DEFINE_LAYOUTS(type, suffix) \
+   typedef struct \
+   { \
+      type x, y, vx, vy; \
+      uint8_t cold[COLD_BYTES]; \
+   } Entity##suffix; \
+   typedef struct \
+   { \
+      type x[MAX_SPRITES], y[MAX_SPRITES], vx[MAX_SPRITES], vy[MAX_SPRITES]; \
+   } Arrays##suffix; \
+   typedef struct \
+   { \
+      type x, y, vx, vy; \
+   } Hot##suffix;
+
+DEFINE_LAYOUTS(int32_t, 32)
+DEFINE_LAYOUTS(int16_t, 16)
+
+// Each kernel has its own copy of the entities, so that all kernels
+// start from the same state.
+static union { Entity32 e32[MAX_SPRITES]; Entity16 e16[MAX_SPRITES]; }
+   g_aos_data, g_aos_rand_data;
+static union { Arrays32 a32; Arrays16 a16; } g_soa_data;
+static union { Hot32 h32[MAX_SPRITES]; Hot16 h16[MAX_SPRITES]; }
+   g_hot_data;
+
+// Field type used to initialize entities, -1 if not initialized.
+static int g_initialized_type = -1;
+
+// Bounce off screen edges by reflecting velocity.
+#define BOUNCE(p, v, limit, scale) \
+   do \
+   { \
+      if( (p) < 0 ) \
+         (v) = (v) < 0 ? -(v) : (v); \
+      else if( (p) >= (limit) ) \
+         (v) = (v) < 0 ? (v) : -(v); \
+   } while(0)
+
+// Bounce off screen edges with a new random velocity, which is what
+// AnimateSprite in sprite.c does.
+#define RANDOM_BOUNCE(p, v, limit, scale) \
+   do \
+   { \
+      if( (p) < 0 ) \
+         (v) = (rand() % 8 + 1) * (scale); \
+      else if( (p) >= (limit) ) \
+         (v) = -(rand() % 8 + 1) * (scale); \
+   } while(0)
+
+// Update a single entity given lvalues for its fields.  "scale" is the
+// number of field units per pixel.
+#define UPDATE(x, y, vx, vy, width, height, scale, BOUNCE_OP) \
+   do \
+   { \
+      x += vx; \
+      y += vy; \
+      BOUNCE_OP(x, vx, width, scale); \
+      BOUNCE_OP(y, vy, height, scale); \
+   } while(0)
+
+// Screen size in field units.
+#define FIXED_WIDTH   (LCD_COLUMNS << FIXED_SHIFT)
+#define FIXED_HEIGHT  (LCD_ROWS << FIXED_SHIFT)
+
+// Define a kernel for a layout, with one case for each field type.
+// LOOP is called with the type suffix, screen size in field units, and
+// field units per pixel.
+#define DEFINE_KERNEL(name, LOOP) \
+   static void name(int count) \
+   { \
+      switch( g_type ) \
+      { \
+         case kTypeInt32: LOOP(32, LCD_COLUMNS, LCD_ROWS, 1);  break; \
+         case kTypeInt16: LOOP(16, LCD_COLUMNS, LCD_ROWS, 1);  break; \
+         default: \
+            LOOP(32, FIXED_WIDTH, FIXED_HEIGHT, 1 << FIXED_SHIFT); \
+            break; \
+      } \
+   }
+
+#define AOS_LOOP(n, width, height, scale) \
+   for(int i = 0; i < count; i++) \
+   { \
+      Entity##n *e = g_aos_data.e##n + i; \
+      UPDATE(e->x, e->y, e->vx, e->vy, width, height, scale, BOUNCE); \
+   }
+
+#define AOS_RAND_LOOP(n, width, height, scale) \
+   for(int i = 0; i < count; i++) \
+   { \
+      Entity##n *e = g_aos_rand_data.e##n + i; \
+      UPDATE(e->x, e->y, e->vx, e->vy, width, height, scale, \
+             RANDOM_BOUNCE); \
+   }
+
+#define SOA_LOOP(n, width, height, scale) \
+   for(int i = 0; i < count; i++) \
+   { \
+      Arrays##n *a = &g_soa_data.a##n; \
+      UPDATE(a->x[i], a->y[i], a->vx[i], a->vy[i], \
+             width, height, scale, BOUNCE); \
+   }
+
+#define HOT_COLD_LOOP(n, width, height, scale) \
+   for(int i = 0; i < count; i++) \
+   { \
+      Hot##n *h = g_hot_data.h##n + i; \
+      UPDATE(h->x, h->y, h->vx, h->vy, width, height, scale, BOUNCE); \
+   }
+
+DEFINE_KERNEL(UpdateAos, AOS_LOOP)
+DEFINE_KERNEL(UpdateAosRand, AOS_RAND_LOOP)
+DEFINE_KERNEL(UpdateSoa, SOA_LOOP)
+DEFINE_KERNEL(UpdateHotCold, HOT_COLD_LOOP)
+
+// Set fields of entity i in all layouts.
+#define SET_ENTITY(n, i, px, py, pvx, pvy) \
+   do \
+   { \
+      g_aos_data.e##n[i].x = g_aos_rand_data.e##n[i].x = \
+         g_soa_data.a##n.x[i] = g_hot_data.h##n[i].x = (px); \
+      g_aos_data.e##n[i].y = g_aos_rand_data.e##n[i].y = \
+         g_soa_data.a##n.y[i] = g_hot_data.h##n[i].y = (py); \
+      g_aos_data.e##n[i].vx = g_aos_rand_data.e##n[i].vx = \
+         g_soa_data.a##n.vx[i] = g_hot_data.h##n[i].vx = (pvx); \
+      g_aos_data.e##n[i].vy = g_aos_rand_data.e##n[i].vy = \
+         g_soa_data.a##n.vy[i] = g_hot_data.h##n[i].vy = (pvy); \
+   } while(0)
+
+// Random seed for initial positions and velocities.  This is separate
+// from rand, so that initializing entities does not reset the random
+// state used by other benchmarks.
+static uint32_t g_seed = 1;
+
+// Return a random number in the range [0, limit).  This uses a 64-bit
+// product since fixed point velocity limits do not fit in 16 bits.
+static int Random(int limit)
+{
+   g_seed = g_seed * 1664525u + 1013904223u;
+   return (int)(((uint64_t)g_seed * (uint32_t)limit) >> 32);
+}
+
+// Return a random signed nonzero velocity, in units of 1/scale pixels.
+// Velocities for fixed point fields have fractional parts.
+static int RandomVelocity(int scale)
+{
+   const int v = Random(8 * scale) + 1;
+   return Random(2) != 0 ? v : -v;
+}
+
+// Initialize entities with random positions and velocities.
+static void InitEntities(void)
+{
+   g_initialized_type = g_type;
+   g_seed = 1;
+   for(int i = 0; i < MAX_SPRITES; i++)
+   {
+      const int x = Random(LCD_COLUMNS);
+      const int y = Random(LCD_ROWS);
+      switch( g_type )
+      {
+         case kTypeInt32:
+            SET_ENTITY(32, i, x, y, RandomVelocity(1), RandomVelocity(1));
+            break;
+         case kTypeInt16:
+            SET_ENTITY(16, i, x, y, RandomVelocity(1), RandomVelocity(1));
+            break;
+         default:
+            SET_ENTITY(32, i, x << FIXED_SHIFT, y << FIXED_SHIFT,
+                       RandomVelocity(1 << FIXED_SHIFT),
+                       RandomVelocity(1 << FIXED_SHIFT));
+            break;
+      }
+   }
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, UpdateAos, UpdateAosRand, UpdateSoa, UpdateHotCold
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "layout", kLayoutParams, kKernels, NULL, 0, &g_state
+};
+
+// Exported functions.
+void LayoutBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   if( g_initialized_type != g_type )
+      InitEntities();
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetLayoutBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_ENTITY_COUNT);
+   g_type = kTypeInt32;
+   g_initialized_type = -1;
+}
@@ -0,0 +1,16 @@
+// Benchmark for entity data layouts, updating sprite positions stored as
+// array of structs, struct of arrays, or split into hot and cold parts.
+
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void LayoutBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetLayoutBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kLayoutParams[];
+
+#endif  // LAYOUT_H_
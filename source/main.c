@@ -5,17 +5,51 @@
 
 #include"pd_api.h"
 #include"arith.h"
+#include"fixed.h"
+#include"latency.h"
+#include"simd.h"
+#include"mathfn.h"
+#include"double.h"
 #include"memory.h"
+#include"bandwidth.h"
+#include"chase.h"
+#include"region.h"
+#include"alloc.h"
+#include"layout.h"
+#include"access.h"
+#include"collision.h"
+#include"bitmap.h"
+#include"scroll.h"
+#include"fill.h"
 #include"sprite.h"
 #include"screen.h"
 #include"ruler.h"
+#include"frametime.h"
+#include"sweep.h"
 
 #include"build/version.h"
 
 enum
 {
    kArithmeticBenchmarkMode,
+   kFixedPointBenchmarkMode,
+   kIntLatencyBenchmarkMode,
+   kFloatLatencyBenchmarkMode,
+   kSimdBenchmarkMode,
+   kTrigBenchmarkMode,
+   kSqrtExpBenchmarkMode,
+   kDoubleBenchmarkMode,
    kMemoryBenchmarkMode,
+   kBandwidthBenchmarkMode,
+   kChaseBenchmarkMode,
+   kRegionBenchmarkMode,
+   kAllocBenchmarkMode,
+   kLayoutBenchmarkMode,
+   kAccessBenchmarkMode,
+   kCollisionBenchmarkMode,
+   kBitmapBenchmarkMode,
+   kScrollBenchmarkMode,
+   kFillBenchmarkMode,
    kSpriteBenchmarkMode,
    kScreenBenchmarkMode,
    kMetricRulerMode,
@@ -25,7 +59,10 @@ enum
 };
 static const char *kModeNames[kModeCount] =
 {
-   "math", "memory", "sprites", "screen", "metric ruler", "imperial ruler"
+   "math", "fixed point", "int latency", "float latency", "simd", "trig",
+   "sqrt exp", "double", "memory", "bandwidth", "chase", "region", "alloc",
+   "layout", "access", "collision", "bitmap", "scroll", "fill", "sprites",
+   "screen", "metric ruler", "imperial ruler"
 };
 
 // Selected benchmark.
@@ -33,6 +70,26 @@ static int g_mode = kArithmeticBenchmarkMode;
 static int g_previous_mode = -1;
 static PDMenuItem *g_mode_option = NULL;
 
+// How benchmarks are run.
+enum
+{
+   kRunManual,
+   kRunWithGraph,
+   kRunSweep,
+   kRunSearch30,
+   kRunSearch50,
+
+   kRunCount
+};
+static const char *kRunNames[kRunCount] =
+{
+   "manual", "graph", "sweep", "30 fps", "50 fps"
+};
+
+// Selected run mode.
+static int g_run = kRunManual;
+static PDMenuItem *g_run_option = NULL;
+
 // Button state, used for tracking when to refresh.
 static PDButtons g_button_state = 0;
 static PDButtons g_previous_button_state = kButtonA | kButtonB;
@@ -44,8 +101,22 @@ static LCDBitmap *g_info = NULL;
 static int Update(void *userdata)
 {
    PlaydateAPI *pd = userdata;
+   RecordFrameTime(pd);
 
    int full_refresh = 0;
+   if( UpdateSweep(pd) != 0 )
+   {
+      full_refresh = 1;
+      if( IsSweepActive() == 0 )
+      {
+         // Sweep or search completed, go back to manual mode.  Search
+         // results stay on screen until the next change.
+         g_run = kRunManual;
+         pd->system->setMenuItemValue(g_run_option, g_run);
+         g_previous_mode = -1;
+      }
+   }
+
    if( g_previous_mode != g_mode )
    {
       pd->graphics->clear(kColorWhite);
@@ -54,6 +125,11 @@ static int Update(void *userdata)
 
    PDButtons pushed, released;
    pd->system->getButtonState(&g_button_state, &pushed, &released);
+   if( IsSweepActive() != 0 )
+   {
+      // Input is ignored during sweeps.
+      g_button_state = 0;
+   }
    if( g_previous_button_state != g_button_state )
    {
       g_previous_button_state = g_button_state;
@@ -65,11 +141,62 @@ static int Update(void *userdata)
       case kArithmeticBenchmarkMode:
          ArithmeticBenchmark(pd, g_button_state, full_refresh);
          break;
+      case kFixedPointBenchmarkMode:
+         FixedPointBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kIntLatencyBenchmarkMode:
+         IntLatencyBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kFloatLatencyBenchmarkMode:
+         FloatLatencyBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kSimdBenchmarkMode:
+         SimdBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kTrigBenchmarkMode:
+         TrigBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kSqrtExpBenchmarkMode:
+         SqrtExpBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kDoubleBenchmarkMode:
+         DoubleBenchmark(pd, g_button_state, full_refresh);
+         break;
       case kMemoryBenchmarkMode:
          MemoryBenchmark(pd, g_button_state, full_refresh);
          break;
+      case kBandwidthBenchmarkMode:
+         BandwidthBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kChaseBenchmarkMode:
+         ChaseBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kRegionBenchmarkMode:
+         RegionBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kAllocBenchmarkMode:
+         AllocBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kLayoutBenchmarkMode:
+         LayoutBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kAccessBenchmarkMode:
+         AccessBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kCollisionBenchmarkMode:
+         CollisionBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kBitmapBenchmarkMode:
+         BitmapBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kScrollBenchmarkMode:
+         ScrollBenchmark(pd, g_button_state, full_refresh);
+         break;
+      case kFillBenchmarkMode:
+         FillBenchmark(pd, g_button_state, full_refresh);
+         break;
       case kSpriteBenchmarkMode:
-         SpriteBenchmark(pd, g_button_state);
+         SpriteBenchmark(pd, g_button_state, full_refresh);
          break;
       case kScreenBenchmarkMode:
          ScreenBenchmark(pd, g_button_state, full_refresh);
@@ -82,6 +209,10 @@ static int Update(void *userdata)
          break;
    }
 
+   if( g_run == kRunWithGraph )
+      DrawFrameTimeOverlay(pd);
+   DrawSweepStatus(pd, full_refresh);
+
    if( g_previous_mode != g_mode )
    {
       g_previous_mode = g_mode;
@@ -90,23 +221,120 @@ static int Update(void *userdata)
    return 1;
 }
 
-// Menu callbacks.
-static void ChangeBenchmarkMode(void *userdata)
+// Return adjustable parameters for a mode, or NULL if it has none.
+static const BenchmarkParam *GetParams(int mode)
 {
-   PlaydateAPI *pd = userdata;
-   g_mode = pd->system->getMenuItemValue(g_mode_option);
+   switch( mode )
+   {
+      case kArithmeticBenchmarkMode:
+         return kArithmeticParams;
+      case kFixedPointBenchmarkMode:
+         return kFixedPointParams;
+      case kIntLatencyBenchmarkMode:
+         return kIntLatencyParams;
+      case kFloatLatencyBenchmarkMode:
+         return kFloatLatencyParams;
+      case kSimdBenchmarkMode:
+         return kSimdParams;
+      case kTrigBenchmarkMode:
+         return kTrigParams;
+      case kSqrtExpBenchmarkMode:
+         return kSqrtExpParams;
+      case kDoubleBenchmarkMode:
+         return kDoubleParams;
+      case kMemoryBenchmarkMode:
+         return kMemoryParams;
+      case kBandwidthBenchmarkMode:
+         return kBandwidthParams;
+      case kChaseBenchmarkMode:
+         return kChaseParams;
+      case kRegionBenchmarkMode:
+         return kRegionParams;
+      case kAllocBenchmarkMode:
+         return kAllocParams;
+      case kLayoutBenchmarkMode:
+         return kLayoutParams;
+      case kAccessBenchmarkMode:
+         return kAccessParams;
+      case kCollisionBenchmarkMode:
+         return kCollisionParams;
+      case kBitmapBenchmarkMode:
+         return kBitmapParams;
+      case kScrollBenchmarkMode:
+         return kScrollParams;
+      case kFillBenchmarkMode:
+         return kFillParams;
+      case kSpriteBenchmarkMode:
+         return kSpriteParams;
+      case kScreenBenchmarkMode:
+         return kScreenParams;
+      default:
+         return NULL;
+   }
 }
 
-static void Reset(void *unused_userdata)
+// Reset parameters and state for current mode.
+static void ResetBenchmark(void)
 {
    switch( g_mode )
    {
       case kArithmeticBenchmarkMode:
          ResetArithmeticBenchmark();
          break;
+      case kFixedPointBenchmarkMode:
+         ResetFixedPointBenchmark();
+         break;
+      case kIntLatencyBenchmarkMode:
+         ResetIntLatencyBenchmark();
+         break;
+      case kFloatLatencyBenchmarkMode:
+         ResetFloatLatencyBenchmark();
+         break;
+      case kSimdBenchmarkMode:
+         ResetSimdBenchmark();
+         break;
+      case kTrigBenchmarkMode:
+         ResetTrigBenchmark();
+         break;
+      case kSqrtExpBenchmarkMode:
+         ResetSqrtExpBenchmark();
+         break;
+      case kDoubleBenchmarkMode:
+         ResetDoubleBenchmark();
+         break;
       case kMemoryBenchmarkMode:
          ResetMemoryBenchmark();
          break;
+      case kBandwidthBenchmarkMode:
+         ResetBandwidthBenchmark();
+         break;
+      case kChaseBenchmarkMode:
+         ResetChaseBenchmark();
+         break;
+      case kRegionBenchmarkMode:
+         ResetRegionBenchmark();
+         break;
+      case kAllocBenchmarkMode:
+         ResetAllocBenchmark();
+         break;
+      case kLayoutBenchmarkMode:
+         ResetLayoutBenchmark();
+         break;
+      case kAccessBenchmarkMode:
+         ResetAccessBenchmark();
+         break;
+      case kCollisionBenchmarkMode:
+         ResetCollisionBenchmark();
+         break;
+      case kBitmapBenchmarkMode:
+         ResetBitmapBenchmark();
+         break;
+      case kScrollBenchmarkMode:
+         ResetScrollBenchmark();
+         break;
+      case kFillBenchmarkMode:
+         ResetFillBenchmark();
+         break;
       case kSpriteBenchmarkMode:
          ResetSpriteBenchmark();
          break;
@@ -123,6 +351,83 @@ static void Reset(void *unused_userdata)
    g_previous_mode = -1;
 }
 
+// Stop sweep or search if one is in progress, and go back to manual mode.
+// This also clears results from the last search.
+static void StopRun(PlaydateAPI *pd)
+{
+   const int active = IsSweepActive();
+   StopSweep(pd);
+   if( active != 0 )
+   {
+      g_run = kRunManual;
+      pd->system->setMenuItemValue(g_run_option, g_run);
+   }
+}
+
+// Release resources held by current mode that would affect other modes.
+static void ExitBenchmark(PlaydateAPI *pd)
+{
+   switch( g_mode )
+   {
+      case kCollisionBenchmarkMode:
+         ExitCollisionBenchmark(pd);
+         break;
+      case kSpriteBenchmarkMode:
+         ExitSpriteBenchmark(pd);
+         break;
+      default:
+         break;
+   }
+}
+
+// Menu callbacks.
+static void ChangeBenchmarkMode(void *userdata)
+{
+   PlaydateAPI *pd = userdata;
+   StopRun(pd);
+   const int mode = pd->system->getMenuItemValue(g_mode_option);
+   if( mode != g_mode )
+      ExitBenchmark(pd);
+   g_mode = mode;
+}
+
+static void ChangeRunMode(void *userdata)
+{
+   PlaydateAPI *pd = userdata;
+   g_run = pd->system->getMenuItemValue(g_run_option);
+   StopSweep(pd);
+   if( g_run == kRunSweep || g_run == kRunSearch30 || g_run == kRunSearch50 )
+   {
+      const BenchmarkParam *params = GetParams(g_mode);
+      if( params != NULL )
+      {
+         if( g_run == kRunSweep )
+         {
+            StartSweep(pd, kModeNames[g_mode], params, ResetBenchmark);
+         }
+         else
+         {
+            StartSearch(pd, kModeNames[g_mode], params, ResetBenchmark,
+                        g_run == kRunSearch30 ? 30 : 50);
+         }
+      }
+      if( IsSweepActive() == 0 )
+      {
+         g_run = kRunManual;
+         pd->system->setMenuItemValue(g_run_option, g_run);
+      }
+   }
+
+   // Force full refresh to erase old overlay.
+   g_previous_mode = -1;
+}
+
+static void Reset(void *userdata)
+{
+   StopRun(userdata);
+   ResetBenchmark();
+}
+
 // Initialize info card.
 static void SetMenuImage(PlaydateAPI *pd)
 {
@@ -158,9 +463,11 @@ int eventHandler(PlaydateAPI *pd, PDSystemEvent event, uint32_t unused_arg)
    {
       case kEventInit:
          pd->system->setUpdateCallback(Update, pd);
-         pd->system->addMenuItem("reset", Reset, NULL);
+         pd->system->addMenuItem("reset", Reset, pd);
          g_mode_option = pd->system->addOptionsMenuItem(
             "test", kModeNames, kModeCount, ChangeBenchmarkMode, pd);
+         g_run_option = pd->system->addOptionsMenuItem(
+            "run", kRunNames, kRunCount, ChangeRunMode, pd);
 
          // Update at maximum frame rate.
          pd->display->setRefreshRate(0);
@@ -172,6 +479,11 @@ int eventHandler(PlaydateAPI *pd, PDSystemEvent event, uint32_t unused_arg)
          SetMenuImage(pd);
          break;
 
+      case kEventResume:
+         // Time spent in pause menu is not a real frame.
+         ResetFrameTime();
+         break;
+
       default:
          break;
    }
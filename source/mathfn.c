@@ -0,0 +1,382 @@
+#include"mathfn.h"
+#include"kernel.h"
+#include<math.h>
+#include<stdlib.h>
+
+// Default operation counts.  This is lower than the arithmetic benchmark
+// since each operation is a function call.
+#define DEFAULT_OPERATION_COUNT  0x1000
+
+// Maximum operation count.
+#define MAX_COUNT                0xffffff
+
+// Number of random inputs for each kernel.  Kernels cycle through these.
+#define INPUT_SIZE               256
+
+// Number of evenly spaced inputs for measuring errors.
+#define ERROR_SAMPLES            4096
+
+// Number of entries in sine table, covering a full period.
+#define SIN_TABLE_SIZE           1024
+
+#define PI                       3.14159265f
+
+// Polynomial coefficients.  These were fitted to minimize maximum error:
+// sin(x) for x in [0, pi/2], atan(x) for x in [0, 1], and 2**x for x in
+// [0, 1) with relative error.
+static const float kSinCoefficients[] =
+{
+   0.99999661f, -0.16664828f, 8.3063256e-3f, -1.8363663e-4f
+};
+static const float kAtanCoefficients[] =
+{
+   0.99986633f, -0.33030480f, 0.18015930f, -8.5156330e-2f, 2.0845096e-2f
+};
+static const float kExp2Coefficients[] =
+{
+   0.99999993f, 0.69315307f, 0.24015362f,
+   5.5826317e-2f, 8.9893418e-3f, 1.8775760e-3f
+};
+
+// Inputs, filled with random values on first use:
+// angles in [-pi, pi], coordinates in [-1, 1], positive numbers in
+// [1/1024, 1024], and exponents in [-8, 8].
+static float g_angles[INPUT_SIZE];
+static float g_coords_x[INPUT_SIZE];
+static float g_coords_y[INPUT_SIZE];
+static float g_positives[INPUT_SIZE];
+static float g_exponents[INPUT_SIZE];
+
+// Lookup table for sin(x).
+static float g_sin_table[SIN_TABLE_SIZE];
+
+static int g_tables_initialized = 0;
+
+// Sum of results, declared volatile so that the kernels are not optimized
+// away.
+static volatile float g_result;
+
+// Sine with nearest table entry.  Valid for x > -8*pi, since the offset
+// added to the table index needs to keep it positive.
+static inline float SinLut(float x)
+{
+   const int i = (int)(x * (SIN_TABLE_SIZE / (2 * PI)) +
+                       (SIN_TABLE_SIZE * 4 + 0.5f));
+   return g_sin_table[i & (SIN_TABLE_SIZE - 1)];
+}
+
+// Sine with linear interpolation between table entries.
+static inline float SinLerp(float x)
+{
+   const float f = x * (SIN_TABLE_SIZE / (2 * PI)) + SIN_TABLE_SIZE * 4;
+   const int i = (int)f;
+   const float a = g_sin_table[i & (SIN_TABLE_SIZE - 1)];
+   const float b = g_sin_table[(i + 1) & (SIN_TABLE_SIZE - 1)];
+   return a + (b - a) * (f - (float)i);
+}
+
+// Sine with polynomial approximation.
+static inline float SinPoly(float x)
+{
+   // Reduce to [-pi, pi], then reflect to [-pi/2, pi/2].
+   const float k = x * (1 / (2 * PI));
+   x -= (2 * PI) * (float)(int)(k + (k >= 0 ? 0.5f : -0.5f));
+   if( x > PI / 2 )
+      x = PI - x;
+   else if( x < -PI / 2 )
+      x = -PI - x;
+
+   const float x2 = x * x;
+   return x * (kSinCoefficients[0] +
+               x2 * (kSinCoefficients[1] +
+                     x2 * (kSinCoefficients[2] +
+                           x2 * kSinCoefficients[3])));
+}
+
+// Arctangent with polynomial approximation.
+static inline float Atan2Poly(float y, float x)
+{
+   // Reduce to first octant.
+   const float ax = fabsf(x);
+   const float ay = fabsf(y);
+   if( ax == 0 && ay == 0 )
+      return 0;
+   const float z = ax > ay ? ay / ax : ax / ay;
+
+   const float z2 = z * z;
+   float a = z * (kAtanCoefficients[0] +
+                  z2 * (kAtanCoefficients[1] +
+                        z2 * (kAtanCoefficients[2] +
+                              z2 * (kAtanCoefficients[3] +
+                                    z2 * kAtanCoefficients[4]))));
+   if( ay > ax )
+      a = PI / 2 - a;
+   if( x < 0 )
+      a = PI - a;
+   return y < 0 ? -a : a;
+}
+
+// Square root with VSQRT instruction.  sqrtf does the same thing, but
+// also checks for negative inputs to set errno.  Targets without VFP
+// use sqrtf.
+static inline float SqrtHardware(float x)
+{
+#if defined(__arm__) && defined(__ARM_FP)
+   float r;
+   __asm__("vsqrt.f32 %0, %1" : "=t"(r) : "t"(x));
+   return r;
+#else
+   return sqrtf(x);
+#endif
+}
+
+// Square root from inverse square root estimate, refined with one step
+// of Newton's method.
+static inline float SqrtFast(float x)
+{
+   union { float f; uint32_t i; } u = {x};
+   u.i = 0x5f3759df - (u.i >> 1);
+   return x * u.f * (1.5f - 0.5f * x * u.f * u.f);
+}
+
+// Exponential with polynomial approximation.  Valid for |x| < 87.
+static inline float ExpPoly(float x)
+{
+   // exp(x) = 2**(x * log2(e)), split into integer and fractional parts.
+   const float t = x * 1.44269504f;
+   float n = (float)(int)t;
+   if( n > t )
+      n -= 1;
+   const float f = t - n;
+
+   union { float f; int32_t i; } u;
+   u.f = kExp2Coefficients[0] +
+         f * (kExp2Coefficients[1] +
+              f * (kExp2Coefficients[2] +
+                   f * (kExp2Coefficients[3] +
+                        f * (kExp2Coefficients[4] +
+                             f * kExp2Coefficients[5]))));
+   u.i += (int32_t)((uint32_t)(int32_t)n << 23);
+   return u.f;
+}
+
+// Define a kernel that sums results of a single argument function.
+#define DEFINE_KERNEL(name, function, inputs) \
+   static void name(int count) \
+   { \
+      float sum = 0; \
+      for(int i = 0; i < count; i++) \
+         sum += function(inputs[i & (INPUT_SIZE - 1)]); \
+      g_result = sum; \
+   }
+
+// Define a kernel that sums results of an atan2 function.
+#define DEFINE_ATAN2_KERNEL(name, function) \
+   static void name(int count) \
+   { \
+      float sum = 0; \
+      for(int i = 0; i < count; i++) \
+      { \
+         const int j = i & (INPUT_SIZE - 1); \
+         sum += function(g_coords_y[j], g_coords_x[j]); \
+      } \
+      g_result = sum; \
+   }
+
+DEFINE_KERNEL(SinfKernel, sinf, g_angles)
+DEFINE_KERNEL(SinLutKernel, SinLut, g_angles)
+DEFINE_KERNEL(SinLerpKernel, SinLerp, g_angles)
+DEFINE_KERNEL(SinPolyKernel, SinPoly, g_angles)
+DEFINE_KERNEL(CosfKernel, cosf, g_angles)
+DEFINE_ATAN2_KERNEL(Atan2fKernel, atan2f)
+DEFINE_ATAN2_KERNEL(Atan2PolyKernel, Atan2Poly)
+DEFINE_KERNEL(SqrtfKernel, sqrtf, g_positives)
+DEFINE_KERNEL(SqrtHardwareKernel, SqrtHardware, g_positives)
+DEFINE_KERNEL(SqrtFastKernel, SqrtFast, g_positives)
+DEFINE_KERNEL(ExpfKernel, expf, g_exponents)
+DEFINE_KERNEL(ExpPolyKernel, ExpPoly, g_exponents)
+
+// Trigonometric functions.
+static int g_sinf = DEFAULT_OPERATION_COUNT;
+static int g_sin_lut = DEFAULT_OPERATION_COUNT;
+static int g_sin_lerp = DEFAULT_OPERATION_COUNT;
+static int g_sin_poly = DEFAULT_OPERATION_COUNT;
+static int g_cosf = DEFAULT_OPERATION_COUNT;
+static int g_atan2f = DEFAULT_OPERATION_COUNT;
+static int g_atan2_poly = DEFAULT_OPERATION_COUNT;
+static float g_trig_costs[7];
+static float g_trig_errors[7];
+
+const BenchmarkParam kTrigParams[] =
+{
+   {"sinf",       &g_sinf,       0, MAX_COUNT, 1, g_trig_costs + 0},
+   {"sin_lut",    &g_sin_lut,    0, MAX_COUNT, 1, g_trig_costs + 1},
+   {"sin_lerp",   &g_sin_lerp,   0, MAX_COUNT, 1, g_trig_costs + 2},
+   {"sin_poly",   &g_sin_poly,   0, MAX_COUNT, 1, g_trig_costs + 3},
+   {"cosf",       &g_cosf,       0, MAX_COUNT, 1, g_trig_costs + 4},
+   {"atan2f",     &g_atan2f,     0, MAX_COUNT, 1, g_trig_costs + 5},
+   {"atan2_poly", &g_atan2_poly, 0, MAX_COUNT, 1, g_trig_costs + 6},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+static const KernelFunction kTrigKernels[] =
+{
+   SinfKernel, SinLutKernel, SinLerpKernel, SinPolyKernel,
+   CosfKernel, Atan2fKernel, Atan2PolyKernel
+};
+
+static KernelState g_trig_state;
+
+static const KernelSet kTrigKernelSet =
+{
+   "trig", kTrigParams, kTrigKernels, g_trig_errors, 0, &g_trig_state
+};
+
+// Square root and exponential functions.
+static int g_sqrtf = DEFAULT_OPERATION_COUNT;
+static int g_sqrt_vsqrt = DEFAULT_OPERATION_COUNT;
+static int g_sqrt_fast = DEFAULT_OPERATION_COUNT;
+static int g_expf = DEFAULT_OPERATION_COUNT;
+static int g_exp_poly = DEFAULT_OPERATION_COUNT;
+static float g_sqrt_exp_costs[5];
+static float g_sqrt_exp_errors[5];
+
+const BenchmarkParam kSqrtExpParams[] =
+{
+   {"sqrtf",       &g_sqrtf,       0, MAX_COUNT, 1, g_sqrt_exp_costs + 0},
+   {"sqrt_vsqrt",  &g_sqrt_vsqrt,  0, MAX_COUNT, 1, g_sqrt_exp_costs + 1},
+   {"sqrt_fast",   &g_sqrt_fast,   0, MAX_COUNT, 1, g_sqrt_exp_costs + 2},
+   {"expf",        &g_expf,        0, MAX_COUNT, 1, g_sqrt_exp_costs + 3},
+   {"exp_poly",    &g_exp_poly,    0, MAX_COUNT, 1, g_sqrt_exp_costs + 4},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+static const KernelFunction kSqrtExpKernels[] =
+{
+   SqrtfKernel, SqrtHardwareKernel, SqrtFastKernel, ExpfKernel, ExpPolyKernel
+};
+
+static KernelState g_sqrt_exp_state;
+
+static const KernelSet kSqrtExpKernelSet =
+{
+   "sqrt exp", kSqrtExpParams, kSqrtExpKernels, g_sqrt_exp_errors, 0,
+   &g_sqrt_exp_state
+};
+
+// Return a random number in [lo, hi].
+static float RandomFloat(float lo, float hi)
+{
+   return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+// Return maximum error of "f" compared to "reference" over [lo, hi].
+// Error is relative to the expected value if "relative" is nonzero,
+// otherwise it's the absolute error.
+static float MaxError(float (*f)(float),
+                      double (*reference)(double),
+                      float lo, float hi, int relative)
+{
+   double max_error = 0;
+   for(int i = 0; i < ERROR_SAMPLES; i++)
+   {
+      const float x = lo + (hi - lo) * ((float)i + 0.5f) / ERROR_SAMPLES;
+      const double expected = reference((double)x);
+      double error = fabs((double)f(x) - expected);
+      if( relative != 0 )
+         error /= fabs(expected);
+      if( error > max_error )
+         max_error = error;
+   }
+   return (float)max_error;
+}
+
+// Return maximum absolute error of an atan2 function, over points around
+// the unit circle.
+static float MaxAtan2Error(float (*f)(float, float))
+{
+   double max_error = 0;
+   for(int i = 0; i < ERROR_SAMPLES; i++)
+   {
+      const float t = -PI + 2 * PI * ((float)i + 0.5f) / ERROR_SAMPLES;
+      const float x = cosf(t);
+      const float y = sinf(t);
+      const double error =
+         fabs((double)f(y, x) - atan2((double)y, (double)x));
+      if( error > max_error )
+         max_error = error;
+   }
+   return (float)max_error;
+}
+
+// Initialize inputs and lookup tables, and measure errors.
+//
+// Errors are measured against double precision functions.  This is slow
+// on the device since there is no double precision FPU, so it's only
+// done once on first use.
+static void InitTables(PlaydateAPI *pd)
+{
+   if( g_tables_initialized != 0 )
+      return;
+   g_tables_initialized = 1;
+
+   for(int i = 0; i < INPUT_SIZE; i++)
+   {
+      g_angles[i] = RandomFloat(-PI, PI);
+      g_coords_x[i] = RandomFloat(-1, 1);
+      g_coords_y[i] = RandomFloat(-1, 1);
+      g_positives[i] = RandomFloat(1.0f / 1024, 1024);
+      g_exponents[i] = RandomFloat(-8, 8);
+   }
+   for(int i = 0; i < SIN_TABLE_SIZE; i++)
+      g_sin_table[i] = sinf((float)i * (2 * PI / SIN_TABLE_SIZE));
+
+   g_trig_errors[0] = MaxError(sinf, sin, -PI, PI, 0);
+   g_trig_errors[1] = MaxError(SinLut, sin, -PI, PI, 0);
+   g_trig_errors[2] = MaxError(SinLerp, sin, -PI, PI, 0);
+   g_trig_errors[3] = MaxError(SinPoly, sin, -PI, PI, 0);
+   g_trig_errors[4] = MaxError(cosf, cos, -PI, PI, 0);
+   g_trig_errors[5] = MaxAtan2Error(atan2f);
+   g_trig_errors[6] = MaxAtan2Error(Atan2Poly);
+   g_sqrt_exp_errors[0] = MaxError(sqrtf, sqrt, 1.0f / 1024, 1024, 1);
+   g_sqrt_exp_errors[1] = MaxError(SqrtHardware, sqrt, 1.0f / 1024, 1024, 1);
+   g_sqrt_exp_errors[2] = MaxError(SqrtFast, sqrt, 1.0f / 1024, 1024, 1);
+   g_sqrt_exp_errors[3] = MaxError(expf, exp, -8, 8, 1);
+   g_sqrt_exp_errors[4] = MaxError(ExpPoly, exp, -8, 8, 1);
+
+   for(int i = 0; kTrigParams[i].name != NULL; i++)
+   {
+      pd->system->logToConsole("%s: max error = %.3e",
+                               kTrigParams[i].name,
+                               (double)g_trig_errors[i]);
+   }
+   for(int i = 0; kSqrtExpParams[i].name != NULL; i++)
+   {
+      pd->system->logToConsole("%s: max relative error = %.3e",
+                               kSqrtExpParams[i].name,
+                               (double)g_sqrt_exp_errors[i]);
+   }
+}
+
+// Exported functions.
+void TrigBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   InitTables(pd);
+   KernelBenchmark(pd, &kTrigKernelSet, buttons, full_refresh);
+}
+
+void ResetTrigBenchmark(void)
+{
+   ResetKernelSet(&kTrigKernelSet, DEFAULT_OPERATION_COUNT);
+}
+
+void SqrtExpBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   InitTables(pd);
+   KernelBenchmark(pd, &kSqrtExpKernelSet, buttons, full_refresh);
+}
+
+void ResetSqrtExpBenchmark(void)
+{
+   ResetKernelSet(&kSqrtExpKernelSet, DEFAULT_OPERATION_COUNT);
+}
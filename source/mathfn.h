@@ -0,0 +1,24 @@
+// Benchmark for math library functions, compared against lookup tables
+// and polynomial approximations.
+//
+// There are two tests: "trig" for sin/cos/atan2, and "sqrt exp" for
+// square roots and exponentials.  Each reports the maximum error of each
+// implementation in addition to its cost.
+
+#ifndef MATHFN_H_
+#define MATHFN_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void TrigBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetTrigBenchmark(void);
+
+void SqrtExpBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetSqrtExpBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kTrigParams[];
+extern const BenchmarkParam kSqrtExpParams[];
+
+#endif  // MATHFN_H_
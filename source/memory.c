@@ -1,4 +1,5 @@
 #include"memory.h"
+#include"timer.h"
 
 // Default memory access counts.
 //
@@ -11,8 +12,8 @@
 // that requires shipping extra fonts.
 #define DEFAULT_ACCESS_COUNT  0x2000
 
-// Maximum number of words to allocate.
-#define MAX_WORD_COUNT        0x200000
+// Number of iterations for measuring loop overhead.
+#define CALIBRATION_COUNT     0x2000
 
 // Operation counts.
 static int g_seq_write = DEFAULT_ACCESS_COUNT;
@@ -20,8 +21,34 @@ static int g_seq_read = DEFAULT_ACCESS_COUNT;
 static int g_rand_write = DEFAULT_ACCESS_COUNT;
 static int g_rand_read = DEFAULT_ACCESS_COUNT;
 
+// Measured cycles per access.
+static float g_seq_write_cost = 0;
+static float g_seq_read_cost = 0;
+static float g_rand_write_cost = 0;
+static float g_rand_read_cost = 0;
+
+// Measured cycles per iteration of an empty loop, and of loops that only
+// generate random indices for random writes and reads.  These overheads
+// are included in the costs of sequential and random accesses
+// respectively, and are subtracted to get the cost of the memory accesses
+// themselves.  Random writes and reads are calibrated separately since
+// they use different moduli, and divide time depends on the operands.
+static float g_loop_cost = 0;
+static float g_rand_write_overhead = 0;
+static float g_rand_read_overhead = 0;
+
+const BenchmarkParam kMemoryParams[] =
+{
+   {"seq_write",  &g_seq_write,  0, MAX_WORD_COUNT, 1, &g_seq_write_cost},
+   {"seq_read",   &g_seq_read,   0, MAX_WORD_COUNT, 1, &g_seq_read_cost},
+   {"rand_write", &g_rand_write, 0, MAX_WORD_COUNT, 1, &g_rand_write_cost},
+   {"rand_read",  &g_rand_read,  0, MAX_WORD_COUNT, 1, &g_rand_read_cost},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
 // Preallocated memory buffer, declared volatile to disable compiler operations.
-static volatile int g_memory[MAX_WORD_COUNT];
+volatile int g_memory[MAX_WORD_COUNT];
+int g_memory_has_chain = 0;
 
 // Random seed.
 static int g_seed = 1;
@@ -38,7 +65,11 @@ static inline int Rand(int *seed)
    //
    // By the way, ARM toolchain uses Newlib, and the random number generator
    // there is another LCG, except it uses 64bit operations instead of 32bits.
-   *seed = (*seed * 1103515245 + 12345) & 0x7fffffff;
+   //
+   // Arithmetic is unsigned since signed overflow is undefined, and the
+   // compiler may take advantage of that in ways that produce out of range
+   // indices.
+   *seed = (int)(((uint32_t)*seed * 1103515245u + 12345u) & 0x7fffffff);
 
    // glibc will actually return bits 30..0, so we should return
    // "*seed & 0x3fffffff".  We are not doing that here because we are
@@ -50,31 +81,74 @@ static inline int Rand(int *seed)
    return *seed;
 }
 
+// Update cost of generating random indices with the given modulus, which
+// is the access count of the random loop being calibrated.  The empty asm
+// statement keeps the compiler from removing the computation without
+// adding a memory access.
+static void UpdateRandOverhead(PlaydateAPI *pd,
+                               float *cycles_per_iteration,
+                               int *seed,
+                               int modulus)
+{
+   if( modulus <= 0 )
+   {
+      *cycles_per_iteration = 0;
+      return;
+   }
+   // Seed is kept in a local variable, as in RunBenchmark.
+   int local_seed = *seed;
+   const uint32_t t0 = GetTimestamp(pd);
+   for(int i = 0; i < CALIBRATION_COUNT; i++)
+   {
+      const int index = Rand(&local_seed) % modulus;
+      __asm__ volatile("" : : "r"(index));
+   }
+   const uint32_t t1 = GetTimestamp(pd);
+   UpdateCost(cycles_per_iteration, t1 - t0, CALIBRATION_COUNT);
+   *seed = local_seed;
+}
+
 // Run access test.
 // https://gcc.godbolt.org/z/qdn493886
-static void RunBenchmark(void)
+static void RunBenchmark(PlaydateAPI *pd)
 {
    // Read result.  We don't need to make this volatile to disable
    // optimizations, since g_memory is already volatile.
    int read_result = 0;
 
+   // Each loop is timed separately, so that the costs are not mixed with
+   // drawing and display updates.
+   UpdateLoopCost(pd, &g_loop_cost, CALIBRATION_COUNT);
+
+   uint32_t t0 = GetTimestamp(pd);
    for(int i = 0; i < g_seq_write; i++)
       g_memory[i] = i;
+   uint32_t t1 = GetTimestamp(pd);
+   UpdateCost(&g_seq_write_cost, t1 - t0, g_seq_write);
+
+   t0 = GetTimestamp(pd);
    for(int i = 0; i < g_seq_read; i++)
       read_result = g_memory[i];
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_seq_read_cost, t1 - t0, g_seq_read);
 
    // Make random seed local to reduce memory access.
    int seed = g_seed;
-   if( g_rand_write > 0 )
-   {
-      for(int i = 0; i < g_rand_write; i++)
-         g_memory[Rand(&seed) % g_rand_write] = i;
-   }
-   if( g_rand_read > 0 )
-   {
-      for(int i = 0; i < g_rand_read; i++)
-         read_result = g_memory[Rand(&seed) % g_rand_read];
-   }
+
+   UpdateRandOverhead(pd, &g_rand_write_overhead, &seed, g_rand_write);
+   UpdateRandOverhead(pd, &g_rand_read_overhead, &seed, g_rand_read);
+
+   t0 = GetTimestamp(pd);
+   for(int i = 0; i < g_rand_write; i++)
+      g_memory[Rand(&seed) % g_rand_write] = i;
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_rand_write_cost, t1 - t0, g_rand_write);
+
+   t0 = GetTimestamp(pd);
+   for(int i = 0; i < g_rand_read; i++)
+      read_result = g_memory[Rand(&seed) % g_rand_read];
+   t1 = GetTimestamp(pd);
+   UpdateCost(&g_rand_read_cost, t1 - t0, g_rand_read);
 
    // Read from read_result, otherwise we get a compiler warning for
    // having a local variable that's set but not used.
@@ -84,6 +158,12 @@ static void RunBenchmark(void)
    g_seed = seed;
 }
 
+// Return cost in nanoseconds with overhead subtracted.
+static float NetNanoseconds(float cycles, float overhead)
+{
+   return CyclesToNanoseconds(SubtractOverhead(cycles, overhead));
+}
+
 // Draw frame rate and help text.
 static void DrawStatus(PlaydateAPI *pd, int full_refresh)
 {
@@ -93,25 +173,63 @@ static void DrawStatus(PlaydateAPI *pd, int full_refresh)
    int length;
    if( full_refresh != 0 )
    {
-      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 185, kColorWhite);
+      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 225, kColorWhite);
       length = pd->system->formatString(
          &text,
-         "FPS = %.1f\n"
+         "FPS = %.1f, loop = %.2f ns, rand = %.2f, %.2f ns\n"
          "sequential: write = %d, read = %d\n"
-         "random: write = %d, read = %d\n\n"
+         "random: write = %d, read = %d\n"
+         "ns/op: %.2f, %.2f, %.2f, %.2f\n"
+         "cycles/op: %.2f, %.2f, %.2f, %.2f\n"
+         "net ns/op: %.2f, %.2f, %.2f, %.2f\n"
          /* Left */  "\u2b05 + crank: adjust sequential writes\n"
          /* Up */    "\u2b06 + crank: adjust sequential reads\n"
          /* Right */ "\u27a1 + crank: adjust random writes\n"
          /* Down */  "\u2b07 + crank: adjust random reads\n"
          /* A */     "\u24b6 + crank: adjust everything at once",
          (double)fps,
+         (double)CyclesToNanoseconds(g_loop_cost),
+         (double)CyclesToNanoseconds(g_rand_write_overhead),
+         (double)CyclesToNanoseconds(g_rand_read_overhead),
          g_seq_write * sizeof(int), g_seq_read * sizeof(int),
-         g_rand_write * sizeof(int), g_rand_read * sizeof(int));
+         g_rand_write * sizeof(int), g_rand_read * sizeof(int),
+         (double)CyclesToNanoseconds(g_seq_write_cost),
+         (double)CyclesToNanoseconds(g_seq_read_cost),
+         (double)CyclesToNanoseconds(g_rand_write_cost),
+         (double)CyclesToNanoseconds(g_rand_read_cost),
+         (double)g_seq_write_cost, (double)g_seq_read_cost,
+         (double)g_rand_write_cost, (double)g_rand_read_cost,
+         (double)NetNanoseconds(g_seq_write_cost, g_loop_cost),
+         (double)NetNanoseconds(g_seq_read_cost, g_loop_cost),
+         (double)NetNanoseconds(g_rand_write_cost, g_rand_write_overhead),
+         (double)NetNanoseconds(g_rand_read_cost, g_rand_read_overhead));
    }
    else
    {
-      pd->graphics->fillRect(0, 0, 128, 25, kColorWhite);
-      length = pd->system->formatString(&text, "FPS = %.1f", (double)fps);
+      // Frame rate and measured costs are updated every frame, the
+      // parameter lines in between are left as is.
+      pd->graphics->fillRect(0, 0, LCD_COLUMNS, 25, kColorWhite);
+      pd->graphics->fillRect(0, 65, LCD_COLUMNS, 60, kColorWhite);
+      length = pd->system->formatString(
+         &text,
+         "FPS = %.1f, loop = %.2f ns, rand = %.2f, %.2f ns\n\n\n"
+         "ns/op: %.2f, %.2f, %.2f, %.2f\n"
+         "cycles/op: %.2f, %.2f, %.2f, %.2f\n"
+         "net ns/op: %.2f, %.2f, %.2f, %.2f",
+         (double)fps,
+         (double)CyclesToNanoseconds(g_loop_cost),
+         (double)CyclesToNanoseconds(g_rand_write_overhead),
+         (double)CyclesToNanoseconds(g_rand_read_overhead),
+         (double)CyclesToNanoseconds(g_seq_write_cost),
+         (double)CyclesToNanoseconds(g_seq_read_cost),
+         (double)CyclesToNanoseconds(g_rand_write_cost),
+         (double)CyclesToNanoseconds(g_rand_read_cost),
+         (double)g_seq_write_cost, (double)g_seq_read_cost,
+         (double)g_rand_write_cost, (double)g_rand_read_cost,
+         (double)NetNanoseconds(g_seq_write_cost, g_loop_cost),
+         (double)NetNanoseconds(g_seq_read_cost, g_loop_cost),
+         (double)NetNanoseconds(g_rand_write_cost, g_rand_write_overhead),
+         (double)NetNanoseconds(g_rand_read_cost, g_rand_read_overhead));
    }
    pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
    pd->system->realloc(text, 0);
@@ -130,29 +248,29 @@ static void HandleInput(PlaydateAPI *pd, PDButtons buttons)
 {
    if( (buttons & (kButtonA | kButtonB)) != 0 )
    {
-      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 205, LCD_COLUMNS, 20, kColorXOR);
       buttons |= kButtonLeft | kButtonRight | kButtonUp | kButtonDown;
    }
    const int delta = 256 * pd->system->getCrankChange();
 
    if( (buttons & kButtonLeft) != 0 )
    {
-      pd->graphics->fillRect(0, 85, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_seq_write, delta);
    }
    if( (buttons & kButtonUp) != 0 )
    {
-      pd->graphics->fillRect(0, 105, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_seq_read, delta);
    }
    if( (buttons & kButtonRight) != 0 )
    {
-      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_rand_write, delta);
    }
    if( (buttons & kButtonDown) != 0 )
    {
-      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 185, LCD_COLUMNS, 20, kColorXOR);
       AdjustOp(&g_rand_read, delta);
    }
 }
@@ -163,14 +281,16 @@ void MemoryBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
    if( buttons != 0 )
       full_refresh = 1;
 
-   RunBenchmark();
+   g_memory_has_chain = 0;
+   RunBenchmark(pd);
    DrawStatus(pd, full_refresh);
    HandleInput(pd, buttons);
 
-   pd->graphics->markUpdatedRows(5, full_refresh != 0 ? 184 : 24);
+   pd->graphics->markUpdatedRows(5, full_refresh != 0 ? 224 : 124);
 }
 
 void ResetMemoryBenchmark(void)
 {
    g_seq_write = g_seq_read = g_rand_write = g_rand_read = DEFAULT_ACCESS_COUNT;
+   g_seed = 1;
 }
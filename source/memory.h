@@ -4,8 +4,22 @@
 #define MEMORY_H_
 
 #include"pd_api.h"
+#include"param.h"
 
 void MemoryBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
 void ResetMemoryBenchmark(void);
 
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kMemoryParams[];
+
+// Maximum number of words to allocate.
+#define MAX_WORD_COUNT  0x200000
+
+// Preallocated memory buffer, shared with other memory benchmarks.
+extern volatile int g_memory[MAX_WORD_COUNT];
+
+// Nonzero if g_memory holds the pointer chain built by the chase
+// benchmark.  Benchmarks that write to g_memory should clear this.
+extern int g_memory_has_chain;
+
 #endif  // MEMORY_H_
@@ -0,0 +1,31 @@
+// Adjustable benchmark parameters.
+//
+// Each benchmark exports a table of its parameters, so that they can be
+// set by tools other than the crank, such as the host runner.
+
+#ifndef PARAM_H_
+#define PARAM_H_
+
+typedef struct
+{
+   // Short name without spaces, e.g. "int_add".  A NULL name marks the
+   // end of a parameter table.
+   const char *name;
+
+   // Current value.
+   int *value;
+
+   // Bounds for value, inclusive.
+   int min, max;
+
+   // Nonzero if value is the number of operations executed per frame,
+   // as opposed to some other setting such as sprite size.
+   int is_count;
+
+   // Smoothed cost of each operation in CPU cycles, see timer.h.  NULL if
+   // operations for this parameter are not timed separately.  This may be
+   // set to zero to discard earlier measurements.
+   float *cycles_per_op;
+} BenchmarkParam;
+
+#endif  // PARAM_H_
@@ -0,0 +1,249 @@
+#include"region.h"
+#include<stdint.h>
+#include"kernel.h"
+
+// Default access counts.
+#define DEFAULT_ACCESS_COUNT  0x4000
+
+// Maximum access count.
+#define MAX_COUNT             0xffffff
+
+// Buffer size ranges from 256 bytes to 64K, well beyond the size of the
+// data cache.  The stack buffer is limited to 8K, since it holds two
+// areas of that size (16K total) and needs to leave room for everything
+// else on the stack.
+#define MIN_SIZE_LOG2         8
+#define MAX_SIZE_LOG2         16
+#define MAX_STACK_SIZE_LOG2   13
+#define MAX_BUFFER_WORDS      ((1 << MAX_SIZE_LOG2) / 4)
+#define MAX_STACK_WORDS       ((1 << MAX_STACK_SIZE_LOG2) / 4)
+#define DEFAULT_SIZE_LOG2     12
+
+// All buffers are aligned to cache lines, so that differences between
+// regions are not caused by alignment.
+#define CACHE_LINE_BYTES      32
+#define CACHE_LINE_WORDS      (CACHE_LINE_BYTES / 4)
+
+// Buffer placement.
+enum
+{
+   kRegionBss,
+   kRegionData,
+   kRegionHeap,
+   kRegionStack,
+
+   kRegionCount
+};
+
+// Settings.
+static int g_region = kRegionBss;
+static int g_size_log2 = DEFAULT_SIZE_LOG2;
+
+// Number of loads or stores.
+static int g_chase = DEFAULT_ACCESS_COUNT;
+static int g_read = DEFAULT_ACCESS_COUNT;
+static int g_write = DEFAULT_ACCESS_COUNT;
+static int g_copy = DEFAULT_ACCESS_COUNT;
+static float g_costs[4];
+
+const BenchmarkParam kRegionParams[] =
+{
+   {"region",    &g_region,    0, kRegionCount - 1, 0, NULL},
+   {"size_log2", &g_size_log2, MIN_SIZE_LOG2, MAX_SIZE_LOG2, 0, NULL},
+   {"chase",     &g_chase,     0, MAX_COUNT, 1, g_costs + 0},
+   {"read",      &g_read,      0, MAX_COUNT, 1, g_costs + 1},
+   {"write",     &g_write,     0, MAX_COUNT, 1, g_costs + 2},
+   {"copy",      &g_copy,      0, MAX_COUNT, 1, g_costs + 3},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Static buffers.  The .data buffer has a nonzero initializer so that it
+// is not placed in .bss.
+//
+// Each buffer holds two areas of the selected size: the first holds the
+// chain for the chase kernel, and the second is accessed by the other
+// kernels, so that they do not overwrite the chain.
+static int g_bss_buffer[2 * MAX_BUFFER_WORDS]
+   __attribute__((aligned(CACHE_LINE_BYTES)));
+static int g_data_buffer[2 * MAX_BUFFER_WORDS]
+   __attribute__((aligned(CACHE_LINE_BYTES))) = {1};
+
+// Heap buffer, allocated on first use and kept until exit.  g_heap_block
+// is the allocated block, g_heap_buffer is aligned within that block.
+static void *g_heap_block = NULL;
+static int *g_heap_buffer = NULL;
+
+// Areas used by kernels for the current frame, and the size of each
+// area in words.
+static volatile int *g_chain = NULL;
+static volatile int *g_data = NULL;
+static int g_words = MAX_BUFFER_WORDS;
+
+// Area and size used to build the current chain.
+static volatile int *g_built_chain = NULL;
+static int g_built_words = 0;
+
+// Word index where the next chase starts.
+static int g_chase_index = 0;
+
+// Read result, declared volatile to disable compiler optimizations around
+// it.
+static volatile int g_result = 0;
+
+// Build a random cyclic chain through each cache line of the chain area,
+// see BuildChain in chase.c.
+//
+// This uses its own fixed seed instead of srand, so that the chain is
+// reproducible without resetting the random state used elsewhere.
+static void BuildChain(void)
+{
+   g_built_chain = g_chain;
+   g_built_words = g_words;
+
+   const int node_count = g_words / CACHE_LINE_WORDS;
+   for(int i = 0; i < node_count; i++)
+      g_chain[i * CACHE_LINE_WORDS] = i * CACHE_LINE_WORDS;
+
+   uint32_t seed = 1;
+   for(int i = node_count - 1; i > 0; i--)
+   {
+      seed = seed * 1103515245u + 12345u;
+      const int j = (int)((seed >> 1) % (uint32_t)i);
+      const int t = g_chain[i * CACHE_LINE_WORDS];
+      g_chain[i * CACHE_LINE_WORDS] = g_chain[j * CACHE_LINE_WORDS];
+      g_chain[j * CACHE_LINE_WORDS] = t;
+   }
+   if( g_chase_index >= g_words )
+      g_chase_index = 0;
+}
+
+// Kernels.  Each kernel wraps around to the start of its area when it
+// runs past the end.
+
+// Follow the chain, one dependent load at a time.
+static void Chase(int count)
+{
+   int index = g_chase_index;
+   for(int i = 0; i < count; i++)
+      index = g_chain[index];
+   g_chase_index = index;
+}
+
+// Sequential loads.
+static void Read(int count)
+{
+   const int mask = g_words - 1;
+   int sum = 0;
+   for(int i = 0; i < count; i++)
+      sum += g_data[i & mask];
+   g_result = sum;
+}
+
+// Sequential stores.
+static void Write(int count)
+{
+   const int mask = g_words - 1;
+   for(int i = 0; i < count; i++)
+      g_data[i & mask] = i;
+}
+
+// Copy from second half of buffer to first half, one word at a time.
+// Count is number of words copied.
+static void Copy(int count)
+{
+   const int half = g_words / 2;
+   const int mask = half - 1;
+   for(int i = 0; i < count; i++)
+      g_data[i & mask] = g_data[half + (i & mask)];
+}
+
+static const KernelFunction kKernels[] =
+{
+   NULL, NULL, Chase, Read, Write, Copy
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+   "region", kRegionParams, kKernels, NULL, 0, &g_state
+};
+
+// Run kernels on selected buffer.  The chain is only built when the
+// buffer or size changes, so that building it does not leave the chain
+// area in cache for every frame.
+static void RunWithBuffer(PlaydateAPI *pd,
+                          volatile int *buffer,
+                          PDButtons buttons,
+                          int full_refresh)
+{
+   g_words = 1 << (g_size_log2 - 2);
+   g_chain = buffer;
+   g_data = buffer + g_words;
+   if( g_chain != g_built_chain || g_words != g_built_words )
+      BuildChain();
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+   g_chain = g_data = NULL;
+}
+
+// Run kernels on a buffer allocated on the stack.  This is a separate
+// function so that the other regions do not pay for the stack space.
+//
+// Stack contents do not persist across frames, so the chain is rebuilt
+// every frame for this region, and chase costs for sizes that fit in
+// cache will be lower than for other regions.
+__attribute__((noinline))
+static void RunWithStackBuffer(PlaydateAPI *pd,
+                               PDButtons buttons,
+                               int full_refresh)
+{
+   int buffer[2 * MAX_STACK_WORDS]
+      __attribute__((aligned(CACHE_LINE_BYTES)));
+   g_built_chain = NULL;
+   RunWithBuffer(pd, buffer, buttons, full_refresh);
+   g_built_chain = NULL;
+}
+
+// Exported functions.
+void RegionBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   switch( g_region )
+   {
+      case kRegionBss:
+         RunWithBuffer(pd, g_bss_buffer, buttons, full_refresh);
+         break;
+      case kRegionData:
+         RunWithBuffer(pd, g_data_buffer, buttons, full_refresh);
+         break;
+      case kRegionHeap:
+         if( g_heap_block == NULL )
+         {
+            g_heap_block = pd->system->realloc(
+               NULL, 2 * MAX_BUFFER_WORDS * 4 + CACHE_LINE_BYTES);
+            if( g_heap_block == NULL )
+            {
+               pd->system->logToConsole("region: out of memory");
+               return;
+            }
+            g_heap_buffer = (int*)(((uintptr_t)g_heap_block +
+                                    CACHE_LINE_BYTES - 1) &
+                                   ~(uintptr_t)(CACHE_LINE_BYTES - 1));
+         }
+         RunWithBuffer(pd, g_heap_buffer, buttons, full_refresh);
+         break;
+      default:
+         if( g_size_log2 > MAX_STACK_SIZE_LOG2 )
+            g_size_log2 = MAX_STACK_SIZE_LOG2;
+         RunWithStackBuffer(pd, buttons, full_refresh);
+         break;
+   }
+}
+
+void ResetRegionBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_ACCESS_COUNT);
+   g_region = kRegionBss;
+   g_size_log2 = DEFAULT_SIZE_LOG2;
+   g_chase_index = 0;
+   g_built_chain = NULL;
+}
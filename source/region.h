@@ -0,0 +1,16 @@
+// Benchmark for memory placement, running the same kernels on buffers in
+// static data, heap, and stack.
+
+#ifndef REGION_H_
+#define REGION_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void RegionBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetRegionBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kRegionParams[];
+
+#endif  // REGION_H_
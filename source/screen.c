@@ -10,6 +10,13 @@
 static int g_min_row = 0;
 static int g_max_row = LCD_ROWS - 1;
 
+const BenchmarkParam kScreenParams[] =
+{
+   {"min_row", &g_min_row, 0, LCD_ROWS - MIN_REFRESH_HEIGHT, 0, NULL},
+   {"max_row", &g_max_row, MIN_REFRESH_HEIGHT - 1, LCD_ROWS - 1, 0, NULL},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
 // Text positions.
 static int g_fps_y = 0;
 static int g_help_y = 0;
@@ -137,6 +144,11 @@ void ScreenBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
    if( buttons != 0 )
       full_refresh = 1;
 
+   // Parameters set from outside of HandleInput are only range checked
+   // individually, so enforce the minimum distance between rows here.
+   if( g_min_row + MIN_REFRESH_HEIGHT - 1 > g_max_row )
+      g_max_row = g_min_row + MIN_REFRESH_HEIGHT - 1;
+
    g_fps_y = (g_min_row + g_max_row - MIN_REFRESH_HEIGHT) / 2;
    g_help_y = g_fps_y > LCD_ROWS / 2 ? 5 : LCD_ROWS - 65;
 
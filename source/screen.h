@@ -4,8 +4,12 @@
 #define SCREEN_H_
 
 #include"pd_api.h"
+#include"param.h"
 
 void ScreenBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
 void ResetScreenBenchmark(void);
 
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kScreenParams[];
+
 #endif  // SCREEN_H_
@@ -0,0 +1,422 @@
+#include"scroll.h"
+#include<stdint.h>
+#include<string.h>
+#include"timer.h"
+
+// Status text occupies the top of the screen, and the world is drawn
+// below it.  Status is never scrolled.
+#define LINE_HEIGHT       20
+#define STATUS_HEIGHT     (5 + 3 * LINE_HEIGHT)
+#define WORLD_TOP         STATUS_HEIGHT
+#define WORLD_HEIGHT      (LCD_ROWS - WORLD_TOP)
+
+// World width in pixels.  Scrolling wraps around at the end.
+#define WORLD_WIDTH       2048
+
+// Tile sizes range from 8 to 32 pixels.
+#define MIN_TILE_LOG2     3
+#define MAX_TILE_LOG2     5
+#define DEFAULT_TILE_LOG2 4
+
+// Maximum world size in tiles.
+#define MAX_WORLD_COLUMNS (WORLD_WIDTH >> MIN_TILE_LOG2)
+#define MAX_WORLD_ROWS    \
+   ((WORLD_HEIGHT + (1 << MIN_TILE_LOG2) - 1) >> MIN_TILE_LOG2)
+
+// Number of distinct tile images.
+#define TILE_IMAGE_COUNT  16
+
+// Scroll speed in pixels per frame.
+#define MAX_SPEED         32
+#define DEFAULT_SPEED     2
+
+// Degrees of crank movement for each step of a setting.
+#define SETTING_STEP_ANGLE  30
+
+// Drawing strategies.
+enum
+{
+   // Call drawBitmap for every visible tile.
+   kStrategyTiles,
+
+   // Draw the visible part of a single pre-rendered world bitmap.
+   kStrategyBackground,
+
+   // Shift frame buffer rows left, and draw only the tiles in the newly
+   // exposed strip on the right.
+   kStrategyShift,
+
+   // Draw with pd->graphics->tilemap.
+   kStrategyTilemap,
+
+   kStrategyCount
+};
+static const char *kStrategyNames[kStrategyCount] =
+{
+   "tiles", "background", "shift", "tilemap"
+};
+
+// Settings.
+static int g_strategy = kStrategyTiles;
+static int g_speed = DEFAULT_SPEED;
+static int g_tile_log2 = DEFAULT_TILE_LOG2;
+
+const BenchmarkParam kScrollParams[] =
+{
+   {"strategy",  &g_strategy,  0, kStrategyCount - 1,        0, NULL},
+   {"speed",     &g_speed,     0, MAX_SPEED,                 0, NULL},
+   {"tile_log2", &g_tile_log2, MIN_TILE_LOG2, MAX_TILE_LOG2, 0, NULL},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Smoothed cycles spent updating the world each frame.
+static float g_draw_cost = 0;
+
+// Horizontal scroll position in pixels, always less than WORLD_WIDTH.
+static int g_scroll_x = 0;
+
+// Nonzero if the frame buffer holds the world at g_scroll_x, so that the
+// shift strategy can reuse it.
+static int g_world_valid = 0;
+
+// Number of rows refreshed in the previous frame.
+static int g_rows_refreshed = LCD_ROWS;
+
+// Tile size of the current world, 0 if not built.
+static int g_world_tile_log2 = 0;
+
+// Tile images, and the same images in a bitmap table for tilemaps.
+static LCDBitmap *g_tile_images[TILE_IMAGE_COUNT];
+static LCDBitmapTable *g_tile_table = NULL;
+
+// Tile index for each world cell, row major.
+static uint16_t g_tiles[MAX_WORLD_ROWS * MAX_WORLD_COLUMNS];
+static int g_columns = 0;
+static int g_rows = 0;
+
+// Pre-rendered world, built on demand for the background strategy.
+static LCDBitmap *g_background = NULL;
+
+// Tilemap, built on demand for the tilemap strategy.
+static LCDTileMap *g_tilemap = NULL;
+
+// Crank movement not yet applied to settings, in degrees.
+static float g_crank_angle = 0;
+
+// Random seed for tile images and world.
+static uint32_t g_seed = 1;
+
+// Return a random number in the range [0, limit).
+static int Random(int limit)
+{
+   g_seed = g_seed * 1664525u + 1013904223u;
+   return (int)(((g_seed >> 16) * (uint32_t)limit) >> 16);
+}
+
+// Draw tile image k into the current context.  Tiles have a random
+// speckle pattern with a different density for each image, and a black
+// line along the top and left edges.
+static void DrawTileImage(PlaydateAPI *pd, int k, int size)
+{
+   pd->graphics->clear(kColorWhite);
+   for(int y = 0; y < size; y++)
+   {
+      for(int x = 0; x < size; x++)
+      {
+         if( Random(TILE_IMAGE_COUNT) < k )
+            pd->graphics->setPixel(x, y, kColorBlack);
+      }
+   }
+   pd->graphics->fillRect(0, 0, size, 1, kColorBlack);
+   pd->graphics->fillRect(0, 0, 1, size, kColorBlack);
+}
+
+// Release world and everything derived from it.
+static void FreeWorld(PlaydateAPI *pd)
+{
+   if( g_world_tile_log2 == 0 )
+      return;
+   if( g_tilemap != NULL )
+      pd->graphics->tilemap->freeTilemap(g_tilemap);
+   g_tilemap = NULL;
+   if( g_background != NULL )
+      pd->graphics->freeBitmap(g_background);
+   g_background = NULL;
+   pd->graphics->freeBitmapTable(g_tile_table);
+   g_tile_table = NULL;
+   g_world_tile_log2 = 0;
+}
+
+// Build tile images and world map if tile size has changed.
+static void UpdateWorld(PlaydateAPI *pd)
+{
+   if( g_world_tile_log2 == g_tile_log2 )
+      return;
+   FreeWorld(pd);
+   g_world_tile_log2 = g_tile_log2;
+   g_world_valid = 0;
+
+   const int size = 1 << g_tile_log2;
+   g_seed = 1;
+   g_tile_table = pd->graphics->newBitmapTable(TILE_IMAGE_COUNT, size, size);
+   for(int k = 0; k < TILE_IMAGE_COUNT; k++)
+   {
+      g_tile_images[k] = pd->graphics->getTableBitmap(g_tile_table, k);
+      pd->graphics->pushContext(g_tile_images[k]);
+      DrawTileImage(pd, k, size);
+      pd->graphics->popContext();
+   }
+
+   g_columns = WORLD_WIDTH >> g_tile_log2;
+   g_rows = (WORLD_HEIGHT + size - 1) >> g_tile_log2;
+   for(int i = 0; i < g_rows * g_columns; i++)
+      g_tiles[i] = (uint16_t)Random(TILE_IMAGE_COUNT);
+}
+
+// Draw tiles that cover screen columns [left, right) at the current
+// scroll position.
+static void DrawTiles(PlaydateAPI *pd, int left, int right)
+{
+   const int log2 = g_tile_log2;
+   const int first = (g_scroll_x + left) >> log2;
+   const int last = (g_scroll_x + right - 1) >> log2;
+   for(int row = 0; row < g_rows; row++)
+   {
+      const uint16_t *tiles = g_tiles + row * g_columns;
+      const int y = WORLD_TOP + (row << log2);
+      for(int column = first; column <= last; column++)
+      {
+         pd->graphics->drawBitmap(g_tile_images[tiles[column % g_columns]],
+                                  (column << log2) - g_scroll_x, y,
+                                  kBitmapUnflipped);
+      }
+   }
+}
+
+// Draw the visible part of the background bitmap, drawing a second copy
+// where the world wraps around.
+static void DrawBackground(PlaydateAPI *pd)
+{
+   if( g_background == NULL )
+   {
+      g_background =
+         pd->graphics->newBitmap(WORLD_WIDTH, WORLD_HEIGHT, kColorWhite);
+      pd->graphics->pushContext(g_background);
+      for(int row = 0; row < g_rows; row++)
+      {
+         for(int column = 0; column < g_columns; column++)
+         {
+            pd->graphics->drawBitmap(
+               g_tile_images[g_tiles[row * g_columns + column]],
+               column << g_tile_log2, row << g_tile_log2, kBitmapUnflipped);
+         }
+      }
+      pd->graphics->popContext();
+   }
+
+   pd->graphics->drawBitmap(g_background, -g_scroll_x, WORLD_TOP,
+                            kBitmapUnflipped);
+   if( g_scroll_x + LCD_COLUMNS > WORLD_WIDTH )
+   {
+      pd->graphics->drawBitmap(g_background, WORLD_WIDTH - g_scroll_x,
+                               WORLD_TOP, kBitmapUnflipped);
+   }
+}
+
+// Draw with tilemap, drawing a second copy where the world wraps around.
+// Returns 0 if tilemaps are not available.
+static int DrawTilemap(PlaydateAPI *pd)
+{
+   const struct playdate_tilemap *api = pd->graphics->tilemap;
+   if( api == NULL )
+      return 0;
+   if( g_tilemap == NULL )
+   {
+      g_tilemap = api->newTilemap();
+      api->setImageTable(g_tilemap, g_tile_table);
+      api->setSize(g_tilemap, g_columns, g_rows);
+      api->setTiles(g_tilemap, g_tiles, g_rows * g_columns, g_columns);
+   }
+
+   api->drawAtPoint(g_tilemap, (float)-g_scroll_x, (float)WORLD_TOP);
+   if( g_scroll_x + LCD_COLUMNS > WORLD_WIDTH )
+   {
+      api->drawAtPoint(g_tilemap, (float)(WORLD_WIDTH - g_scroll_x),
+                       (float)WORLD_TOP);
+   }
+   return 1;
+}
+
+// Shift world rows of frame buffer left by "pixels", leaving the rightmost
+// "pixels" columns to be redrawn.  Byte aligned shifts use memmove, other
+// shifts combine adjacent bytes.
+static void ShiftRows(uint8_t *frame, int pixels)
+{
+   const int row_bytes = LCD_COLUMNS / 8;
+   const int bytes = pixels >> 3;
+   const int bits = pixels & 7;
+   for(int y = WORLD_TOP; y < LCD_ROWS; y++)
+   {
+      uint8_t *row = frame + y * LCD_ROWSIZE;
+      if( bits == 0 )
+      {
+         memmove(row, row + bytes, row_bytes - bytes);
+         continue;
+      }
+      for(int i = 0; i + bytes < row_bytes - 1; i++)
+      {
+         row[i] = (uint8_t)((row[i + bytes] << bits) |
+                            (row[i + bytes + 1] >> (8 - bits)));
+      }
+      row[row_bytes - 1 - bytes] = (uint8_t)(row[row_bytes - 1] << bits);
+   }
+}
+
+// Advance scroll position and update world area of the screen.  Returns
+// nonzero if the world area changed.
+static int UpdateScreen(PlaydateAPI *pd)
+{
+   if( g_world_valid != 0 && g_speed == 0 )
+      return 0;
+
+   const int previous_valid = g_world_valid;
+   g_scroll_x = (g_scroll_x + g_speed) % WORLD_WIDTH;
+   g_world_valid = 1;
+   pd->graphics->setDrawMode(kDrawModeCopy);
+   switch( g_strategy )
+   {
+      case kStrategyTiles:
+         DrawTiles(pd, 0, LCD_COLUMNS);
+         break;
+      case kStrategyBackground:
+         DrawBackground(pd);
+         break;
+      case kStrategyShift:
+         if( previous_valid == 0 )
+         {
+            DrawTiles(pd, 0, LCD_COLUMNS);
+            break;
+         }
+         ShiftRows(pd->graphics->getFrame(), g_speed);
+         pd->graphics->setClipRect(LCD_COLUMNS - g_speed, WORLD_TOP,
+                                   g_speed, WORLD_HEIGHT);
+         DrawTiles(pd, LCD_COLUMNS - g_speed, LCD_COLUMNS);
+         pd->graphics->clearClipRect();
+         break;
+      default:
+         if( DrawTilemap(pd) == 0 )
+         {
+            pd->graphics->fillRect(0, WORLD_TOP, LCD_COLUMNS, WORLD_HEIGHT,
+                                   kColorWhite);
+         }
+         break;
+   }
+   return 1;
+}
+
+// Draw frame rate and settings, and help text on full refresh.
+static void DrawStatus(PlaydateAPI *pd, int full_refresh)
+{
+   const int height = full_refresh != 0 ? STATUS_HEIGHT : 2 * LINE_HEIGHT;
+   pd->graphics->fillRect(0, 0, LCD_COLUMNS, height, kColorWhite);
+   pd->graphics->setDrawMode(kDrawModeCopy);
+
+   const char *note = g_strategy == kStrategyTilemap &&
+                      pd->graphics->tilemap == NULL ? ", not available" : "";
+   char *text = NULL;
+   const int length = pd->system->formatString(
+      &text,
+      "FPS = %.1f  (%s%s)  rows = %d\n"
+      "speed = %d, tile = %d, draw = %.2f ms",
+      (double)pd->display->getFPS(), kStrategyNames[g_strategy], note,
+      g_rows_refreshed, g_speed, 1 << g_tile_log2,
+      (double)(CyclesToNanoseconds(g_draw_cost) * 1e-6f));
+   pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
+   pd->system->realloc(text, 0);
+
+   if( full_refresh != 0 )
+   {
+      static const char kHelp[] =
+         /* Up */   "\u2b06 + crank: speed, "
+         /* Down */ "\u2b07: tile size, "
+         /* B */    "\u24b7: strategy";
+      pd->graphics->drawText(kHelp, sizeof(kHelp) - 1, kUTF8Encoding,
+                             5, 5 + 2 * LINE_HEIGHT);
+   }
+}
+
+// Apply crank movement to a setting, one step for every
+// SETTING_STEP_ANGLE degrees.
+static void AdjustSetting(int *setting, int min, int max, float crank)
+{
+   g_crank_angle += crank;
+   const int steps = (int)(g_crank_angle / SETTING_STEP_ANGLE);
+   g_crank_angle -= steps * SETTING_STEP_ANGLE;
+   *setting += steps;
+   if( *setting < min ) { *setting = min; }
+   if( *setting > max ) { *setting = max; }
+}
+
+// Handle user input.
+static void HandleInput(PlaydateAPI *pd, PDButtons buttons)
+{
+   const float crank = pd->system->getCrankChange();
+   if( (buttons & kButtonB) != 0 )
+   {
+      const int previous = g_strategy;
+      AdjustSetting(&g_strategy, 0, kStrategyCount - 1, crank);
+      if( g_strategy != previous )
+         g_world_valid = 0;
+   }
+   else if( (buttons & kButtonDown) != 0 )
+   {
+      AdjustSetting(&g_tile_log2, MIN_TILE_LOG2, MAX_TILE_LOG2, crank);
+   }
+   else if( (buttons & kButtonUp) != 0 )
+   {
+      AdjustSetting(&g_speed, 0, MAX_SPEED, crank);
+   }
+   else
+   {
+      g_crank_angle = 0;
+   }
+}
+
+// Exported functions.
+void ScrollBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   if( full_refresh != 0 )
+   {
+      // Screen may have been cleared by the caller, so the shift strategy
+      // needs to redraw everything.
+      g_world_valid = 0;
+   }
+   UpdateWorld(pd);
+
+   const uint32_t t0 = GetTimestamp(pd);
+   const int world_changed = UpdateScreen(pd);
+   UpdateCost(&g_draw_cost, GetTimestamp(pd) - t0, 1);
+
+   DrawStatus(pd, full_refresh);
+   HandleInput(pd, buttons);
+
+   if( full_refresh != 0 || world_changed != 0 )
+   {
+      pd->graphics->markUpdatedRows(0, LCD_ROWS - 1);
+      g_rows_refreshed = LCD_ROWS;
+   }
+   else
+   {
+      pd->graphics->markUpdatedRows(0, 2 * LINE_HEIGHT - 1);
+      g_rows_refreshed = 2 * LINE_HEIGHT;
+   }
+}
+
+void ResetScrollBenchmark(void)
+{
+   g_strategy = kStrategyTiles;
+   g_speed = DEFAULT_SPEED;
+   g_tile_log2 = DEFAULT_TILE_LOG2;
+   g_scroll_x = 0;
+   g_world_valid = 0;
+}
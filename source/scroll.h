@@ -0,0 +1,15 @@
+// Benchmark for scrolling a tile world horizontally.
+
+#ifndef SCROLL_H_
+#define SCROLL_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void ScrollBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetScrollBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kScrollParams[];
+
+#endif  // SCROLL_H_
@@ -0,0 +1,272 @@
+#include"simd.h"
+#include"kernel.h"
+#include<stdlib.h>
+
+#if defined(__ARM_FEATURE_SIMD32)
+   #include<arm_acle.h>
+#endif
+
+// Default element counts.
+#define DEFAULT_ELEMENT_COUNT  0x8000
+
+// Maximum element count.
+#define MAX_COUNT              0xffffff
+
+// Buffer size.  Kernels wrap around to the start of the buffer when they
+// run past the end, so this should be small enough to fit in cache.
+#define BUFFER_WORDS           1024
+
+// Element counts.  Counts are in number of bytes for 8-bit operations,
+// and number of samples for 16-bit operations, so that the costs per
+// element are comparable between plain C and DSP versions.
+static int g_add8_c = DEFAULT_ELEMENT_COUNT;
+static int g_add8_simd = DEFAULT_ELEMENT_COUNT;
+static int g_mix16_c = DEFAULT_ELEMENT_COUNT;
+static int g_mix16_simd = DEFAULT_ELEMENT_COUNT;
+static int g_dot16_c = DEFAULT_ELEMENT_COUNT;
+static int g_dot16_simd = DEFAULT_ELEMENT_COUNT;
+static int g_minmax8_c = DEFAULT_ELEMENT_COUNT;
+static int g_minmax8_simd = DEFAULT_ELEMENT_COUNT;
+static float g_costs[8];
+
+const BenchmarkParam kSimdParams[] =
+{
+   {"add8_c",       &g_add8_c,       0, MAX_COUNT, 1, g_costs + 0},
+   {"add8_simd",    &g_add8_simd,    0, MAX_COUNT, 1, g_costs + 1},
+   {"mix16_c",      &g_mix16_c,      0, MAX_COUNT, 1, g_costs + 2},
+   {"mix16_simd",   &g_mix16_simd,   0, MAX_COUNT, 1, g_costs + 3},
+   {"dot16_c",      &g_dot16_c,      0, MAX_COUNT, 1, g_costs + 4},
+   {"dot16_simd",   &g_dot16_simd,   0, MAX_COUNT, 1, g_costs + 5},
+   {"minmax8_c",    &g_minmax8_c,    0, MAX_COUNT, 1, g_costs + 6},
+   {"minmax8_simd", &g_minmax8_simd, 0, MAX_COUNT, 1, g_costs + 7},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Buffer with different views for each element size.
+typedef union
+{
+   uint32_t w[BUFFER_WORDS];
+   int16_t h[BUFFER_WORDS * 2];
+   uint8_t b[BUFFER_WORDS * 4];
+} Buffer;
+
+// Input buffers, filled with random data on first use.
+static Buffer g_input_a, g_input_b;
+static int g_input_initialized = 0;
+
+// Output buffer and result of dot products.  These are declared volatile
+// so that the results are not optimized away.
+static volatile Buffer g_output;
+static volatile uint32_t g_dot_result;
+
+// Packed operations.  Device builds use DSP instructions through ACLE
+// intrinsics, other builds use equivalent plain C.
+#if defined(__ARM_FEATURE_SIMD32)
+
+// Unsigned saturating add of 4 bytes (UQADD8).
+static inline uint32_t SaturatingAdd8(uint32_t a, uint32_t b)
+{
+   return __uqadd8(a, b);
+}
+
+// Signed saturating add of 2 halfwords (QADD16).
+static inline uint32_t SaturatingAdd16(uint32_t a, uint32_t b)
+{
+   return __qadd16(a, b);
+}
+
+// Dual 16-bit multiply with accumulate (SMLAD).
+static inline uint32_t DotProduct16(uint32_t a, uint32_t b, uint32_t sum)
+{
+   return __smlad(a, b, sum);
+}
+
+// Difference between maximum and minimum of each pair of bytes.  USUB8
+// sets GE flags for each byte where a >= b, and SEL selects bytes using
+// those flags.
+static inline uint32_t MinMax8(uint32_t a, uint32_t b)
+{
+   __usub8(a, b);
+   const uint32_t max = __sel(a, b);
+   const uint32_t min = __sel(b, a);
+   return __usub8(max, min);
+}
+
+#else
+
+static inline uint32_t SaturatingAdd8(uint32_t a, uint32_t b)
+{
+   uint32_t r = 0;
+   for(int i = 0; i < 32; i += 8)
+   {
+      const uint32_t s = ((a >> i) & 0xff) + ((b >> i) & 0xff);
+      r |= (s > 0xff ? 0xff : s) << i;
+   }
+   return r;
+}
+
+static inline uint32_t SaturatingAdd16(uint32_t a, uint32_t b)
+{
+   uint32_t r = 0;
+   for(int i = 0; i < 32; i += 16)
+   {
+      int s = (int16_t)(a >> i) + (int16_t)(b >> i);
+      s = s > INT16_MAX ? INT16_MAX : s < INT16_MIN ? INT16_MIN : s;
+      r |= (uint32_t)(uint16_t)s << i;
+   }
+   return r;
+}
+
+static inline uint32_t DotProduct16(uint32_t a, uint32_t b, uint32_t sum)
+{
+   return sum + (uint32_t)((int16_t)a * (int16_t)b) +
+          (uint32_t)((int16_t)(a >> 16) * (int16_t)(b >> 16));
+}
+
+static inline uint32_t MinMax8(uint32_t a, uint32_t b)
+{
+   uint32_t r = 0;
+   for(int i = 0; i < 32; i += 8)
+   {
+      const uint32_t x = (a >> i) & 0xff;
+      const uint32_t y = (b >> i) & 0xff;
+      r |= (x > y ? x - y : y - x) << i;
+   }
+   return r;
+}
+
+#endif
+
+// Kernels.  Plain C versions operate on one element at a time, DSP
+// versions operate on one word at a time.
+
+// Saturating add of 8-bit pixels.
+static void Add8C(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      const int j = i & (BUFFER_WORDS * 4 - 1);
+      const int sum = g_input_a.b[j] + g_input_b.b[j];
+      g_output.b[j] = sum > 255 ? 255 : sum;
+   }
+}
+
+static void Add8Simd(int count)
+{
+   for(int i = 0; i < count / 4; i++)
+   {
+      const int j = i & (BUFFER_WORDS - 1);
+      g_output.w[j] = SaturatingAdd8(g_input_a.w[j], g_input_b.w[j]);
+   }
+}
+
+// Saturating add of 16-bit audio samples.
+static void Mix16C(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      const int j = i & (BUFFER_WORDS * 2 - 1);
+      const int sum = g_input_a.h[j] + g_input_b.h[j];
+      g_output.h[j] = sum > INT16_MAX ? INT16_MAX :
+                      sum < INT16_MIN ? INT16_MIN : sum;
+   }
+}
+
+static void Mix16Simd(int count)
+{
+   for(int i = 0; i < count / 2; i++)
+   {
+      const int j = i & (BUFFER_WORDS - 1);
+      g_output.w[j] = SaturatingAdd16(g_input_a.w[j], g_input_b.w[j]);
+   }
+}
+
+// Dot product of 16-bit samples.  Sums are unsigned so that overflow wraps.
+static void Dot16C(int count)
+{
+   uint32_t sum = 0;
+   for(int i = 0; i < count; i++)
+   {
+      const int j = i & (BUFFER_WORDS * 2 - 1);
+      sum += (uint32_t)(g_input_a.h[j] * g_input_b.h[j]);
+   }
+   g_dot_result = sum;
+}
+
+static void Dot16Simd(int count)
+{
+   uint32_t sum = 0;
+   for(int i = 0; i < count / 2; i++)
+   {
+      const int j = i & (BUFFER_WORDS - 1);
+      sum = DotProduct16(g_input_a.w[j], g_input_b.w[j], sum);
+   }
+   g_dot_result = sum;
+}
+
+// Minimum and maximum of 8-bit values, output is the difference between
+// the two.
+static void MinMax8C(int count)
+{
+   for(int i = 0; i < count; i++)
+   {
+      const int j = i & (BUFFER_WORDS * 4 - 1);
+      const uint8_t a = g_input_a.b[j];
+      const uint8_t b = g_input_b.b[j];
+      const uint8_t max = a > b ? a : b;
+      const uint8_t min = a > b ? b : a;
+      g_output.b[j] = max - min;
+   }
+}
+
+static void MinMax8Simd(int count)
+{
+   for(int i = 0; i < count / 4; i++)
+   {
+      const int j = i & (BUFFER_WORDS - 1);
+      g_output.w[j] = MinMax8(g_input_a.w[j], g_input_b.w[j]);
+   }
+}
+
+static const KernelFunction kKernels[] =
+{
+   Add8C, Add8Simd, Mix16C, Mix16Simd, Dot16C, Dot16Simd, MinMax8C, MinMax8Simd
+};
+
+static KernelState g_state;
+
+static const KernelSet kKernelSet =
+{
+#if defined(__ARM_FEATURE_SIMD32)
+   "simd",
+#else
+   "simd, no DSP",
+#endif
+   kSimdParams, kKernels, NULL, 0, &g_state
+};
+
+// Fill input buffers with random data.
+static void InitInput(void)
+{
+   if( g_input_initialized != 0 )
+      return;
+   g_input_initialized = 1;
+
+   for(int i = 0; i < BUFFER_WORDS * 4; i++)
+   {
+      g_input_a.b[i] = rand();
+      g_input_b.b[i] = rand();
+   }
+}
+
+// Exported functions.
+void SimdBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
+{
+   InitInput();
+   KernelBenchmark(pd, &kKernelSet, buttons, full_refresh);
+}
+
+void ResetSimdBenchmark(void)
+{
+   ResetKernelSet(&kKernelSet, DEFAULT_ELEMENT_COUNT);
+}
@@ -0,0 +1,20 @@
+// Benchmark for packed 8-bit and 16-bit operations.
+//
+// Each operation is implemented both with plain C on individual elements,
+// and with ARMv7E-M DSP instructions operating on whole words.  Builds
+// for targets without DSP instructions use plain C for both, so only the
+// device build shows the real speedup.
+
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+void SimdBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
+void ResetSimdBenchmark(void);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kSimdParams[];
+
+#endif  // SIMD_H_
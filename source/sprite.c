@@ -1,20 +1,97 @@
 #include"sprite.h"
+#include"blit.h"
+#include"timer.h"
 #include<stdlib.h>
+#include<string.h>
 
-#define MAX_SPRITES     10000
 #define MAX_SPRITE_SIZE 512
 
+// Number of pre-shifted copies of each sprite, one for each bit offset
+// within a frame buffer byte.
+#define PRESHIFT_COUNT  8
+
+// Degrees of crank movement for each step of a setting.
+#define SETTING_STEP_ANGLE  30
+
+// Height of the frame rate line, which is the only part of the status
+// text that is redrawn with dirty row refresh.
+#define FPS_LINE_HEIGHT     25
+
+// Drawing methods.
+enum
+{
+   // Clear screen and call drawBitmap for each sprite.
+   kMethodDrawBitmap,
+
+   // Move sprites managed by pd->sprite, and let updateAndDrawSprites
+   // redraw the dirty areas.
+   kMethodSpriteSystem,
+
+   // Clear screen and draw each sprite to the frame buffer with the
+   // software blitter in blit.h.
+   kMethodBlitter,
+
+   kMethodCount
+};
+static const char *kMethodNames[kMethodCount] =
+{
+   "drawBitmap", "sprite system", "blitter"
+};
+
+// Screen refresh strategies for drawBitmap and blitter methods.  The
+// sprite system does its own dirty area tracking.
+enum
+{
+   // Clear and refresh the whole screen every frame.
+   kRefreshFull,
+
+   // Erase only the areas covered by sprites in the previous frame, and
+   // refresh only the rows that were touched.
+   kRefreshDirty,
+
+   kRefreshCount
+};
+static const char *kRefreshNames[kRefreshCount] =
+{
+   "full", "dirty rows"
+};
+
 // Sprite benchmark parameters.
 static int g_circle_count = 0;
 static int g_circle_size = 8;
 static int g_square_count = 0;
 static int g_square_size = 8;
+static int g_method = kMethodDrawBitmap;
+static int g_refresh = kRefreshFull;
+static int g_preshift = 0;
 
-// Sprite animation parameters.
-typedef struct
+// Measured cycles per drawBitmap or Blit call.  For the sprite system,
+// both are set to the cost of moving and drawing all sprites divided by
+// the total sprite count.
+static float g_circle_cost = 0;
+static float g_square_cost = 0;
+
+// Smoothed cost per call for each sprite size, indexed by preshift
+// setting, then drawBitmap (index 0) and blitter (index 1).  These are
+// kept across resets, so that sweeping sprite size with each method fills
+// in all tables.  The blitter does not use preshift, so its costs are
+// only recorded with preshift index 0.
+static float g_circle_size_costs[2][2][MAX_SPRITE_SIZE + 1];
+static float g_square_size_costs[2][2][MAX_SPRITE_SIZE + 1];
+
+const BenchmarkParam kSpriteParams[] =
 {
-   int x, y, vx, vy;
-} Sprite;
+   {"circle_count", &g_circle_count, 0, MAX_SPRITES,     1, &g_circle_cost},
+   {"circle_size",  &g_circle_size,  1, MAX_SPRITE_SIZE, 0, NULL},
+   {"square_count", &g_square_count, 0, MAX_SPRITES,     1, &g_square_cost},
+   {"square_size",  &g_square_size,  1, MAX_SPRITE_SIZE, 0, NULL},
+   {"method",       &g_method,       0, kMethodCount - 1, 0, NULL},
+   {"refresh",      &g_refresh,      0, kRefreshCount - 1, 0, NULL},
+   {"preshift",     &g_preshift,     0, 1,                 0, NULL},
+   {NULL, NULL, 0, 0, 0, NULL}
+};
+
+// Sprite animation parameters.
 static Sprite g_circles[MAX_SPRITES];
 static Sprite g_squares[MAX_SPRITES];
 static int g_circles_initialized = 0;
@@ -26,6 +103,86 @@ static LCDBitmap *g_square_bitmap = NULL;
 static int g_circle_bitmap_size = 0;
 static int g_square_bitmap_size = 0;
 
+// Sprite bitmaps converted for the blitter, updated with the bitmaps.
+static BlitImage g_circle_blit;
+static BlitImage g_square_blit;
+
+// Bytes used by each sprite bitmap and its blitter copy.
+static int g_circle_bytes = 0;
+static int g_square_bytes = 0;
+
+// Pre-shifted copies of a sprite bitmap, built on demand while preshift
+// is enabled for drawBitmap.  Copy k is shifted right by k pixels and is
+// 7 pixels wider than the sprite, so that a sprite at x is drawn by copy
+// (x & 7) at x rounded down to a multiple of 8.
+//
+// The blitter does not use these copies.  It shifts whole words, so byte
+// aligned copies would still need shifting, and it would only draw more
+// pixels.
+typedef struct
+{
+   LCDBitmap *bitmaps[PRESHIFT_COUNT];
+
+   // Sprite size of the copies, 0 if cache is empty.
+   int size;
+
+   // Bytes used by all copies.
+   int bytes;
+} PreshiftCache;
+static PreshiftCache g_circle_cache;
+static PreshiftCache g_square_cache;
+
+// Sprites added to the sprite system, one for each animated sprite.
+typedef struct
+{
+   LCDSprite *sprites[MAX_SPRITES];
+   int count;
+
+   // Size of image assigned to sprites.
+   int image_size;
+} SpriteHandles;
+static SpriteHandles g_circle_handles;
+static SpriteHandles g_square_handles;
+
+// Top left corners of sprites drawn in the previous frame, so that they
+// can be erased with dirty row refresh.
+typedef struct
+{
+   int x, y;
+} Position;
+typedef struct
+{
+   Position positions[MAX_SPRITES];
+   int count;
+   int size;
+} DrawnSprites;
+static DrawnSprites g_drawn_circles;
+static DrawnSprites g_drawn_squares;
+
+// Rows touched in the current frame, and number of rows refreshed in the
+// previous frame.
+static uint8_t g_dirty_rows[LCD_ROWS];
+static int g_rows_refreshed = LCD_ROWS;
+
+// Crank movement not yet applied to settings, in degrees.
+static float g_crank_angle = 0;
+
+// Return bytes of pixel data and mask held by a bitmap and its blitter
+// copy, if any.
+static int GetBitmapBytes(PlaydateAPI *pd,
+                          LCDBitmap *bitmap,
+                          const BlitImage *blit)
+{
+   int width, height, rowbytes;
+   uint8_t *mask, *data;
+   pd->graphics->getBitmapData(bitmap, &width, &height, &rowbytes,
+                               &mask, &data);
+   int bytes = rowbytes * height * (mask != NULL ? 2 : 1);
+   if( blit != NULL && blit->data != NULL )
+      bytes += (2 * blit->height + 1) * blit->stride * (int)sizeof(uint32_t);
+   return bytes;
+}
+
 // Initialize or update circle sprite.
 static void UpdateCircleSprite(PlaydateAPI *pd)
 {
@@ -61,6 +218,11 @@ static void UpdateCircleSprite(PlaydateAPI *pd)
       }
    }
    pd->graphics->popContext();
+
+   FreeBlitImage(&g_circle_blit);
+   if( InitBlitImage(&g_circle_blit, pd, g_circle_bitmap) == 0 )
+      pd->system->logToConsole("sprite: out of memory for blitter");
+   g_circle_bytes = GetBitmapBytes(pd, g_circle_bitmap, &g_circle_blit);
 }
 
 // Initialize or update square sprite.
@@ -77,6 +239,48 @@ static void UpdateSquareSprite(PlaydateAPI *pd)
    pd->graphics->pushContext(g_square_bitmap);
    pd->graphics->fillRect(0, 0, g_square_size, g_square_size, kColorBlack);
    pd->graphics->popContext();
+
+   FreeBlitImage(&g_square_blit);
+   if( InitBlitImage(&g_square_blit, pd, g_square_bitmap) == 0 )
+      pd->system->logToConsole("sprite: out of memory for blitter");
+   g_square_bytes = GetBitmapBytes(pd, g_square_bitmap, &g_square_blit);
+}
+
+// Release all copies held by cache.
+static void FreePreshiftCache(PlaydateAPI *pd, PreshiftCache *cache)
+{
+   if( cache->size == 0 )
+      return;
+   for(int k = 0; k < PRESHIFT_COUNT; k++)
+      pd->graphics->freeBitmap(cache->bitmaps[k]);
+   cache->size = 0;
+   cache->bytes = 0;
+}
+
+// Rebuild pre-shifted copies of a sprite bitmap if sprite size has
+// changed.  Copies are drawn with drawBitmap so that they have the same
+// pixels and mask as the original.
+static void UpdatePreshiftCache(PlaydateAPI *pd,
+                                PreshiftCache *cache,
+                                LCDBitmap *bitmap,
+                                int size)
+{
+   if( cache->size == size )
+      return;
+   FreePreshiftCache(pd, cache);
+   cache->size = size;
+
+   for(int k = 0; k < PRESHIFT_COUNT; k++)
+   {
+      cache->bitmaps[k] = pd->graphics->newBitmap(
+         size + PRESHIFT_COUNT - 1, size, kColorClear);
+      pd->graphics->pushContext(cache->bitmaps[k]);
+      pd->graphics->setDrawMode(kDrawModeCopy);
+      pd->graphics->drawBitmap(bitmap, k, 0, kBitmapUnflipped);
+      pd->graphics->popContext();
+
+      cache->bytes += GetBitmapBytes(pd, cache->bitmaps[k], NULL);
+   }
 }
 
 // Return a random positive number.
@@ -129,22 +333,175 @@ static void AnimateSprite(Sprite *sprites, int *init_count, int count)
    }
 }
 
+// Draw one kind of sprite with drawBitmap or the blitter, and update
+// its cost.
+static void DrawPopulation(PlaydateAPI *pd,
+                           const Sprite *sprites,
+                           int count,
+                           int size,
+                           LCDBitmap *bitmap,
+                           LCDBitmapDrawMode draw_mode,
+                           const BlitImage *blit,
+                           BlitMode blit_mode,
+                           float size_costs[2][MAX_SPRITE_SIZE + 1],
+                           float *cost)
+{
+   const int center = size / 2;
+   if( g_method == kMethodBlitter )
+   {
+      if( blit->data == NULL )
+         return;
+      uint8_t *frame = pd->graphics->getFrame();
+      const uint32_t t0 = GetTimestamp(pd);
+      for(int i = 0; i < count; i++)
+      {
+         Blit(frame, blit,
+              sprites[i].x - center, sprites[i].y - center, blit_mode);
+      }
+      UpdateCost(&size_costs[1][size], GetTimestamp(pd) - t0, count);
+      *cost = size_costs[1][size];
+      return;
+   }
+
+   pd->graphics->setDrawMode(draw_mode);
+   const uint32_t t0 = GetTimestamp(pd);
+   for(int i = 0; i < count; i++)
+   {
+      pd->graphics->drawBitmap(
+         bitmap,
+         sprites[i].x - center,
+         sprites[i].y - center,
+         kBitmapUnflipped);
+   }
+   UpdateCost(&size_costs[0][size], GetTimestamp(pd) - t0, count);
+   *cost = size_costs[0][size];
+}
+
+// Same as DrawPopulation with drawBitmap, but draw each sprite with the
+// pre-shifted copy that matches its bit offset, at a byte aligned
+// position.  Selecting the copy is included in the cost.
+static void DrawPreshiftedPopulation(
+   PlaydateAPI *pd,
+   const Sprite *sprites,
+   int count,
+   int size,
+   const PreshiftCache *cache,
+   LCDBitmapDrawMode draw_mode,
+   float size_costs[2][MAX_SPRITE_SIZE + 1],
+   float *cost)
+{
+   const int center = size / 2;
+   pd->graphics->setDrawMode(draw_mode);
+   const uint32_t t0 = GetTimestamp(pd);
+   for(int i = 0; i < count; i++)
+   {
+      const int x = sprites[i].x - center;
+      pd->graphics->drawBitmap(
+         cache->bitmaps[x & (PRESHIFT_COUNT - 1)],
+         x & ~(PRESHIFT_COUNT - 1),
+         sprites[i].y - center,
+         kBitmapUnflipped);
+   }
+   UpdateCost(&size_costs[0][size], GetTimestamp(pd) - t0, count);
+   *cost = size_costs[0][size];
+}
+
+// Add rows covered by a sprite to dirty rows.
+static void MarkDirtyRows(int y, int height)
+{
+   const int y0 = y < 0 ? 0 : y;
+   const int y1 = y + height > LCD_ROWS ? LCD_ROWS : y + height;
+   for(int row = y0; row < y1; row++)
+      g_dirty_rows[row] = 1;
+}
+
+// Record positions of sprites drawn in the current frame.
+static void RecordSprites(DrawnSprites *drawn,
+                          const Sprite *sprites,
+                          int count,
+                          int size)
+{
+   const int center = size / 2;
+   for(int i = 0; i < count; i++)
+   {
+      drawn->positions[i].x = sprites[i].x - center;
+      drawn->positions[i].y = sprites[i].y - center;
+      MarkDirtyRows(drawn->positions[i].y, size);
+   }
+   drawn->count = count;
+   drawn->size = size;
+}
+
+// Erase sprites drawn in the previous frame.
+static void EraseSprites(PlaydateAPI *pd, const DrawnSprites *drawn)
+{
+   for(int i = 0; i < drawn->count; i++)
+   {
+      const Position *p = drawn->positions + i;
+      pd->graphics->fillRect(p->x, p->y, drawn->size, drawn->size,
+                             kColorWhite);
+      MarkDirtyRows(p->y, drawn->size);
+   }
+}
+
+// Pass dirty rows to markUpdatedRows as the fewest ranges that cover
+// them, and clear them for the next frame.
+static void RefreshDirtyRows(PlaydateAPI *pd)
+{
+   g_rows_refreshed = 0;
+   int start = 0;
+   while( start < LCD_ROWS )
+   {
+      if( g_dirty_rows[start] == 0 )
+      {
+         start++;
+         continue;
+      }
+      int end = start;
+      while( end + 1 < LCD_ROWS && g_dirty_rows[end + 1] != 0 )
+         end++;
+      pd->graphics->markUpdatedRows(start, end);
+      g_rows_refreshed += end - start + 1;
+      start = end + 1;
+   }
+   memset(g_dirty_rows, 0, sizeof(g_dirty_rows));
+}
+
+// Return nonzero if sprites are drawn with pre-shifted copies.
+static int UsePreshift(void)
+{
+   return g_preshift != 0 && g_method == kMethodDrawBitmap;
+}
+
 // Draw sprites.
 static void DrawSprites(PlaydateAPI *pd)
 {
+   const int preshift = UsePreshift();
+   if( preshift == 0 )
+   {
+      FreePreshiftCache(pd, &g_circle_cache);
+      FreePreshiftCache(pd, &g_square_cache);
+   }
+
    if( g_circle_count > 0 )
    {
       UpdateCircleSprite(pd);
       AnimateSprite(g_circles, &g_circles_initialized, g_circle_count);
-      pd->graphics->setDrawMode(kDrawModeCopy);
-      const int center = g_circle_size / 2;
-      for(int i = 0; i < g_circle_count; i++)
+      if( preshift != 0 )
+      {
+         UpdatePreshiftCache(pd, &g_circle_cache,
+                             g_circle_bitmap, g_circle_size);
+         DrawPreshiftedPopulation(pd, g_circles, g_circle_count,
+                                  g_circle_size, &g_circle_cache,
+                                  kDrawModeCopy,
+                                  g_circle_size_costs[1], &g_circle_cost);
+      }
+      else
       {
-         pd->graphics->drawBitmap(
-            g_circle_bitmap,
-            g_circles[i].x - center,
-            g_circles[i].y - center,
-            kBitmapUnflipped);
+         DrawPopulation(pd, g_circles, g_circle_count, g_circle_size,
+                        g_circle_bitmap, kDrawModeCopy,
+                        &g_circle_blit, kBlitMask,
+                        g_circle_size_costs[0], &g_circle_cost);
       }
    }
 
@@ -152,43 +509,207 @@ static void DrawSprites(PlaydateAPI *pd)
    {
       UpdateSquareSprite(pd);
       AnimateSprite(g_squares, &g_squares_initialized, g_square_count);
-      pd->graphics->setDrawMode(kDrawModeNXOR);
-      const int center = g_square_size / 2;
-      for(int i = 0; i < g_square_count; i++)
+      if( preshift != 0 )
       {
-         pd->graphics->drawBitmap(
-            g_square_bitmap,
-            g_squares[i].x - center,
-            g_squares[i].y - center,
-            kBitmapUnflipped);
+         UpdatePreshiftCache(pd, &g_square_cache,
+                             g_square_bitmap, g_square_size);
+         DrawPreshiftedPopulation(pd, g_squares, g_square_count,
+                                  g_square_size, &g_square_cache,
+                                  kDrawModeNXOR,
+                                  g_square_size_costs[1], &g_square_cost);
+      }
+      else
+      {
+         DrawPopulation(pd, g_squares, g_square_count, g_square_size,
+                        g_square_bitmap, kDrawModeNXOR,
+                        &g_square_blit, kBlitNXOR,
+                        g_square_size_costs[0], &g_square_cost);
       }
    }
+
+   RecordSprites(&g_drawn_circles, g_circles, g_circle_count, g_circle_size);
+   RecordSprites(&g_drawn_squares, g_squares, g_square_count, g_square_size);
+}
+
+// Return the smallest sprite size where drawBitmap with the selected
+// preshift setting was measured to be no slower than the blitter, or 0 if
+// there is no such size yet.
+static int FindCrossoverSize(float size_costs[2][2][MAX_SPRITE_SIZE + 1])
+{
+   const float *draw_costs = size_costs[g_preshift][0];
+   const float *blit_costs = size_costs[0][1];
+   for(int size = 1; size <= MAX_SPRITE_SIZE; size++)
+   {
+      if( draw_costs[size] > 0 && blit_costs[size] > 0 &&
+          draw_costs[size] <= blit_costs[size] )
+      {
+         return size;
+      }
+   }
+   return 0;
+}
+
+// Add or remove sprites so that the sprite system holds "count" sprites,
+// and update their image if sprite size has changed.
+static void ResizeHandles(PlaydateAPI *pd,
+                          SpriteHandles *handles,
+                          int count,
+                          LCDBitmap *bitmap,
+                          int size,
+                          LCDBitmapDrawMode mode)
+{
+   while( handles->count > count )
+   {
+      LCDSprite *sprite = handles->sprites[--handles->count];
+      pd->sprite->removeSprite(sprite);
+      pd->sprite->freeSprite(sprite);
+   }
+   if( handles->image_size != size )
+   {
+      for(int i = 0; i < handles->count; i++)
+         pd->sprite->setImage(handles->sprites[i], bitmap, kBitmapUnflipped);
+      handles->image_size = size;
+   }
+   while( handles->count < count )
+   {
+      // Center is set to the top left corner so that sprites are placed
+      // at the same pixel positions as drawBitmap.
+      LCDSprite *sprite = pd->sprite->newSprite();
+      pd->sprite->setImage(sprite, bitmap, kBitmapUnflipped);
+      pd->sprite->setCenter(sprite, 0, 0);
+      pd->sprite->setDrawMode(sprite, mode);
+      pd->sprite->addSprite(sprite);
+      handles->sprites[handles->count++] = sprite;
+   }
+}
+
+// Move sprites in sprite system to animated positions.
+static void MoveHandles(PlaydateAPI *pd,
+                        const SpriteHandles *handles,
+                        const Sprite *sprites,
+                        int center)
+{
+   for(int i = 0; i < handles->count; i++)
+   {
+      pd->sprite->moveTo(handles->sprites[i],
+                         (float)(sprites[i].x - center),
+                         (float)(sprites[i].y - center));
+   }
+}
+
+// Draw sprites through the sprite system.  Bitmaps and animation are
+// updated in the same order as DrawSprites, so that both methods produce
+// the same motion.
+static void DrawSpriteSystem(PlaydateAPI *pd)
+{
+   if( g_circle_count > 0 )
+   {
+      UpdateCircleSprite(pd);
+      AnimateSprite(g_circles, &g_circles_initialized, g_circle_count);
+   }
+   if( g_square_count > 0 )
+   {
+      UpdateSquareSprite(pd);
+      AnimateSprite(g_squares, &g_squares_initialized, g_square_count);
+   }
+   ResizeHandles(pd, &g_circle_handles, g_circle_count,
+                 g_circle_bitmap, g_circle_bitmap_size, kDrawModeCopy);
+   ResizeHandles(pd, &g_square_handles, g_square_count,
+                 g_square_bitmap, g_square_bitmap_size, kDrawModeNXOR);
+
+   const int total = g_circle_count + g_square_count;
+   if( total == 0 )
+      return;
+   const uint32_t t0 = GetTimestamp(pd);
+   MoveHandles(pd, &g_circle_handles, g_circles, g_circle_size / 2);
+   MoveHandles(pd, &g_square_handles, g_squares, g_square_size / 2);
+   pd->sprite->updateAndDrawSprites();
+   UpdateCost(&g_circle_cost, GetTimestamp(pd) - t0, total);
+   g_square_cost = g_circle_cost;
+}
+
+// Format frame rate line of status text, returns length.
+static int FormatFrameRate(PlaydateAPI *pd, char **text)
+{
+   const float fps = pd->display->getFPS();
+   if( g_method == kMethodSpriteSystem )
+   {
+      return pd->system->formatString(
+         text, "FPS = %.1f  (%s)", (double)fps, kMethodNames[g_method]);
+   }
+   return pd->system->formatString(
+      text, "FPS = %.1f  (%s, %s)  rows = %d",
+      (double)fps, kMethodNames[g_method], kRefreshNames[g_refresh],
+      g_rows_refreshed);
+}
+
+// Draw only the frame rate line.
+static void DrawFrameRate(PlaydateAPI *pd)
+{
+   char *text = NULL;
+   const int length = FormatFrameRate(pd, &text);
+   pd->graphics->fillRect(0, 0, LCD_COLUMNS, FPS_LINE_HEIGHT, kColorWhite);
+   pd->graphics->setDrawMode(kDrawModeNXOR);
+   pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
+   pd->system->realloc(text, 0);
+   MarkDirtyRows(0, FPS_LINE_HEIGHT);
 }
 
 // Draw frame rate and help text.
 static void DrawStatus(PlaydateAPI *pd)
 {
-   const float fps = pd->display->getFPS();
+   char *fps_text = NULL;
+   FormatFrameRate(pd, &fps_text);
+
+   // Costs for the sprite system include moving sprites and restoring
+   // the background behind them, while costs for the other methods are
+   // drawing calls only, so the two are labeled differently.
+   const char *cost_label =
+      g_method == kMethodSpriteSystem ? "update ns/sprite" : "draw ns/op";
+
+   // Preshift only applies to drawBitmap.
+   const char *preshift_state =
+      g_preshift == 0 ? "off" : UsePreshift() != 0 ? "on" : "n/a";
 
    char *text = NULL;
    const int length = pd->system->formatString(
       &text,
-      "FPS = %.1f\n"
+      "%s\n"
       "circle: count = %d, size = %d\n"
-      "square: count = %d, size = %d\n\n"
+      "square: count = %d, size = %d\n"
+      "%s: %.0f, %.0f, cycles: %.0f, %.0f\n"
+      "blitter crossover: %d, %d, bytes: %d, %d\n"
       /* Left */  "\u2b05 + crank: adjust circle count\n"
       /* Up */    "\u2b06 + crank: adjust circle size\n"
       /* Right */ "\u27a1 + crank: adjust square count\n"
       /* Down */  "\u2b07 + crank: adjust square size\n"
-      /* A */     "\u24b6 + crank: adjust everything at once",
-      (double)fps,
+      /* A */     "\u24b6 + crank: adjust everything at once\n"
+      /* B */     "\u24b7 + crank: method, \u24b7\u2b06: refresh, "
+                  "\u24b7\u2b07: preshift %s",
+      fps_text,
       g_circle_count, g_circle_size,
-      g_square_count, g_square_size);
+      g_square_count, g_square_size,
+      cost_label,
+      (double)CyclesToNanoseconds(g_circle_cost),
+      (double)CyclesToNanoseconds(g_square_cost),
+      (double)g_circle_cost, (double)g_square_cost,
+      FindCrossoverSize(g_circle_size_costs),
+      FindCrossoverSize(g_square_size_costs),
+      g_circle_bytes + g_circle_cache.bytes,
+      g_square_bytes + g_square_cache.bytes,
+      preshift_state);
 
-   pd->graphics->fillRect(0, 0, 256, 64, kColorWhite);
-   pd->graphics->setDrawMode(kDrawModeNXOR);
+   // Only the lines above the help text are blanked.  The other methods
+   // clear the screen before drawing, so the help text can be drawn with
+   // NXOR to stay visible over sprites.  The sprite system does not clear
+   // the screen, and NXOR would invert the help text on every frame, so
+   // it is drawn with copy instead.
+   pd->graphics->fillRect(0, 0, LCD_COLUMNS, 104, kColorWhite);
+   pd->graphics->setDrawMode(g_method == kMethodSpriteSystem
+                             ? kDrawModeCopy : kDrawModeNXOR);
    pd->graphics->drawText(text, length, kUTF8Encoding, 5, 5);
    pd->system->realloc(text, 0);
+   pd->system->realloc(fps_text, 0);
 }
 
 // Apply adjustment to a single parameter.
@@ -199,52 +720,135 @@ static void AdjustParam(int *param, int delta, int min, int max)
    if( *param > max ) { *param = max; }
 }
 
+// Apply crank movement to a setting with "count" values, one step for
+// every SETTING_STEP_ANGLE degrees.
+static void AdjustSetting(int *setting, int count, float crank)
+{
+   g_crank_angle += crank;
+   for(; g_crank_angle >= SETTING_STEP_ANGLE;
+       g_crank_angle -= SETTING_STEP_ANGLE)
+   {
+      AdjustParam(setting, 1, 0, count - 1);
+   }
+   for(; g_crank_angle <= -SETTING_STEP_ANGLE;
+       g_crank_angle += SETTING_STEP_ANGLE)
+   {
+      AdjustParam(setting, -1, 0, count - 1);
+   }
+}
+
 // Handle user input.
 static void HandleInput(PlaydateAPI *pd, PDButtons buttons)
 {
-   if( (buttons & (kButtonA | kButtonB)) != 0 )
+   const float crank = pd->system->getCrankChange();
+   const int delta = crank;
+   if( (buttons & kButtonB) != 0 )
    {
-      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
+      // Directional buttons select which setting to adjust while B is
+      // held, instead of adjusting counts and sizes.
+      pd->graphics->fillRect(0, 205, LCD_COLUMNS, 20, kColorXOR);
+      if( (buttons & kButtonUp) != 0 )
+         AdjustSetting(&g_refresh, kRefreshCount, crank);
+      else if( (buttons & kButtonDown) != 0 )
+         AdjustSetting(&g_preshift, 2, crank);
+      else
+         AdjustSetting(&g_method, kMethodCount, crank);
+      return;
+   }
+   g_crank_angle = 0;
+
+   if( (buttons & kButtonA) != 0 )
+   {
+      pd->graphics->fillRect(0, 185, LCD_COLUMNS, 20, kColorXOR);
       buttons |= kButtonLeft | kButtonRight | kButtonUp | kButtonDown;
    }
-   const int delta = pd->system->getCrankChange();
 
    if( (buttons & kButtonLeft) != 0 )
    {
-      pd->graphics->fillRect(0, 85, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 105, LCD_COLUMNS, 20, kColorXOR);
       AdjustParam(&g_circle_count, delta, 0, MAX_SPRITES);
    }
    if( (buttons & kButtonUp) != 0 )
    {
-      pd->graphics->fillRect(0, 105, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
       AdjustParam(&g_circle_size, delta, 1, MAX_SPRITE_SIZE);
    }
    if( (buttons & kButtonRight) != 0 )
    {
-      pd->graphics->fillRect(0, 125, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
       AdjustParam(&g_square_count, delta, 0, MAX_SPRITES);
    }
    if( (buttons & kButtonDown) != 0 )
    {
-      pd->graphics->fillRect(0, 145, LCD_COLUMNS, 20, kColorXOR);
+      pd->graphics->fillRect(0, 165, LCD_COLUMNS, 20, kColorXOR);
       AdjustParam(&g_square_size, delta, 1, MAX_SPRITE_SIZE);
    }
 }
 
 // Exported functions.
-void SpriteBenchmark(PlaydateAPI *pd, PDButtons buttons)
+void SpriteBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh)
 {
+   if( g_method == kMethodSpriteSystem )
+   {
+      // Status text and button highlights are drawn outside of the sprite
+      // system, so the whole screen is redrawn while buttons are held to
+      // clean those up.  Otherwise, only the areas covered by moving
+      // sprites are redrawn.
+      pd->graphics->setBackgroundColor(kColorWhite);
+      if( buttons != 0 )
+         pd->sprite->addDirtyRect(LCDMakeRect(0, 0, LCD_COLUMNS, LCD_ROWS));
+      DrawSpriteSystem(pd);
+      DrawStatus(pd);
+      HandleInput(pd, buttons);
+      return;
+   }
+
+   // Release sprites from sprite system after switching methods.
+   ExitSpriteBenchmark(pd);
+
+   if( g_refresh == kRefreshDirty && full_refresh == 0 && buttons == 0 )
+   {
+      // Status text other than the frame rate is not redrawn, so it may
+      // be partially erased until the next full refresh.
+      EraseSprites(pd, &g_drawn_circles);
+      EraseSprites(pd, &g_drawn_squares);
+      DrawSprites(pd);
+      DrawFrameRate(pd);
+      HandleInput(pd, buttons);
+      RefreshDirtyRows(pd);
+      return;
+   }
+
    pd->graphics->clear(kColorWhite);
    DrawSprites(pd);
    DrawStatus(pd);
    HandleInput(pd, buttons);
    pd->graphics->markUpdatedRows(0, LCD_ROWS - 1);
+   memset(g_dirty_rows, 0, sizeof(g_dirty_rows));
+   g_rows_refreshed = LCD_ROWS;
+}
+
+void ExitSpriteBenchmark(PlaydateAPI *pd)
+{
+   ResizeHandles(pd, &g_circle_handles, 0, NULL, 0, kDrawModeCopy);
+   ResizeHandles(pd, &g_square_handles, 0, NULL, 0, kDrawModeCopy);
+}
+
+const Sprite *AnimateCircles(int count)
+{
+   AnimateSprite(g_circles, &g_circles_initialized, count);
+   return g_circles;
 }
 
 void ResetSpriteBenchmark(void)
 {
+   g_circles_initialized = g_squares_initialized = 0;
    g_circle_count = 0;
    g_circle_size = 8;
    g_square_count = 0;
    g_square_size = 8;
+   g_method = kMethodDrawBitmap;
+   g_refresh = kRefreshFull;
+   g_preshift = 0;
+   g_drawn_circles.count = g_drawn_squares.count = 0;
 }
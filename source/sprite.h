@@ -4,8 +4,31 @@
 #define SPRITE_H_
 
 #include"pd_api.h"
+#include"param.h"
 
-void SpriteBenchmark(PlaydateAPI *pd, PDButtons buttons);
+void SpriteBenchmark(PlaydateAPI *pd, PDButtons buttons, int full_refresh);
 void ResetSpriteBenchmark(void);
 
+// Remove sprites added to the sprite system, called when switching to a
+// different benchmark.
+void ExitSpriteBenchmark(PlaydateAPI *pd);
+
+// Adjustable parameters, terminated by an entry with NULL name.
+extern const BenchmarkParam kSpriteParams[];
+
+// Maximum number of sprites of each kind.
+#define MAX_SPRITES  10000
+
+// Position and velocity of an animated sprite.  Position is the center
+// of the sprite.
+typedef struct
+{
+   int x, y, vx, vy;
+} Sprite;
+
+// Animate the first "count" circles drawn by the sprite benchmark, and
+// return the circle array.  New circles get random positions.  This
+// lets other benchmarks run on the same population.
+const Sprite *AnimateCircles(int count);
+
 #endif  // SPRITE_H_
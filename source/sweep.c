@@ -0,0 +1,523 @@
+#include"sweep.h"
+#include<string.h>
+#include"frametime.h"
+#include"timer.h"
+
+// Maximum number of parameters per benchmark.
+#define MAX_PARAMS           8
+
+// Random seed used for all runs.
+#define SWEEP_RANDOM_SEED    1
+
+// Minimum time and frame count for each phase.  Searches use a shorter
+// measurement window since they need more setpoints per parameter.
+#define WARMUP_CYCLES        (CPU_CLOCK_MHZ * 500000)
+#define WARMUP_FRAMES        2
+#define MEASURE_CYCLES       (CPU_CLOCK_MHZ * 2000000)
+#define SEARCH_CYCLES        (CPU_CLOCK_MHZ * 1000000)
+#define MEASURE_FRAMES       5
+
+// Number of steps for parameters that are not operation counts.
+#define LINEAR_STEPS         16
+
+// First nonzero step for operation counts.
+#define FIRST_COUNT_STEP     16
+
+// Searches stop when the range between the largest passing count and
+// the smallest failing count is within 1/SEARCH_PRECISION of the former.
+#define SEARCH_PRECISION     64
+
+// Status line position.
+#define STATUS_Y             (LCD_ROWS - 20)
+
+typedef enum
+{
+   kSweepIdle,
+   kSweepWarmup,
+   kSweepMeasure
+} SweepPhase;
+
+static SweepPhase g_phase = kSweepIdle;
+
+// Target frame rate for searches, zero for sweeps.
+static int g_target_fps = 0;
+
+// Parameters being swept, and their values before the sweep.
+static const BenchmarkParam *g_params = NULL;
+static int g_param_count = 0;
+static int g_saved_values[MAX_PARAMS];
+
+// Index of parameter currently being swept.
+static int g_index = 0;
+
+// Search range for current parameter.  g_pass is the largest count
+// known to meet the target, and g_fail is the smallest count known to
+// miss the target, or -1 if not known yet.
+static int g_pass = 0;
+static int g_fail = -1;
+
+// Search results for each parameter, -1 for parameters not searched.
+static int g_results[MAX_PARAMS];
+static int g_show_results = 0;
+
+// Start of current phase.
+static uint32_t g_phase_start = 0;
+static int g_phase_frames = 0;
+
+// Output file.
+static SDFile *g_file = NULL;
+static char *g_filename = NULL;
+
+// Write formatted text to output file.
+static void WriteText(PlaydateAPI *pd, const char *text, int length)
+{
+   if( g_file != NULL )
+      pd->file->write(g_file, text, length);
+}
+
+// Return the next value after "value" in sweep range, or -1 if there
+// are no more values.
+//
+// Operation counts go up in geometric steps (16, 24, 32, 48, 64, ...),
+// since costs tend to change the most at small counts.  Other parameters
+// go up in linear steps.
+static int NextValue(const BenchmarkParam *p, int value)
+{
+   if( value >= p->max )
+      return -1;
+
+   int next;
+   if( p->is_count != 0 )
+   {
+      if( value < FIRST_COUNT_STEP )
+         next = FIRST_COUNT_STEP;
+      else if( (value & (value - 1)) == 0 )
+         next = value + value / 2;
+      else
+         next = value / 3 * 4;
+   }
+   else
+   {
+      const int step = (p->max - p->min) / LINEAR_STEPS;
+      next = value + (step > 0 ? step : 1);
+   }
+   return next < p->max ? next : p->max;
+}
+
+// Update search range with result of "value", and return the next value
+// to try, or -1 if search is complete.
+//
+// Counts are doubled until the target is missed, and then the range
+// between the last pass and first failure is bisected.
+static int NextSearchValue(const BenchmarkParam *p, int value, int pass)
+{
+   if( pass != 0 )
+   {
+      g_pass = value;
+      if( value >= p->max )
+         return -1;
+      if( g_fail < 0 )
+         return value < p->max / 2 ? value * 2 : p->max;
+   }
+   else
+   {
+      g_fail = value;
+   }
+
+   const int tolerance = g_pass / SEARCH_PRECISION;
+   if( g_fail - g_pass <= (tolerance > 1 ? tolerance : 1) )
+      return -1;
+   return g_pass + (g_fail - g_pass) / 2;
+}
+
+// Set parameters for sweeping the current parameter.
+static void ApplyParams(int value)
+{
+   const BenchmarkParam *swept = g_params + g_index;
+   for(int i = 0; i < g_param_count; i++)
+   {
+      if( i == g_index )
+      {
+         *g_params[i].value = value;
+      }
+      else
+      {
+         // When sweeping an operation count, other counts are set to
+         // zero so that only one kind of operation is measured.  Other
+         // parameters keep their original values.
+         *g_params[i].value =
+            (swept->is_count != 0 && g_params[i].is_count != 0)
+            ? 0 : g_saved_values[i];
+      }
+   }
+}
+
+// Return the parameter whose cost is reported for the current setpoint.
+// Settings have no cost of their own, so sweeping a setting reports the
+// cost of the first operation that is being run.
+static const BenchmarkParam *GetCostParam(void)
+{
+   const BenchmarkParam *swept = g_params + g_index;
+   if( swept->cycles_per_op != NULL )
+      return swept;
+   for(int i = 0; i < g_param_count; i++)
+   {
+      if( g_params[i].cycles_per_op != NULL && *g_params[i].value > 0 )
+         return g_params + i;
+   }
+   return swept;
+}
+
+// Move to the next parameter that can be swept, starting from g_index.
+// Returns 0 if there are no more parameters.
+//
+// Searches only apply to operation counts.
+static int FindParam(void)
+{
+   for(; g_index < g_param_count; g_index++)
+   {
+      const BenchmarkParam *p = g_params + g_index;
+      if( p->min >= p->max )
+         continue;
+      if( g_target_fps > 0 )
+      {
+         if( p->is_count == 0 )
+            continue;
+         g_pass = p->min;
+         g_fail = -1;
+         ApplyParams(p->min > FIRST_COUNT_STEP ? p->min : FIRST_COUNT_STEP);
+      }
+      else
+      {
+         ApplyParams(p->min);
+      }
+      return 1;
+   }
+   return 0;
+}
+
+// Write header line.
+static void WriteHeader(PlaydateAPI *pd)
+{
+   if( g_target_fps > 0 )
+   {
+      static const char kSearchColumns[] = "param,target_fps,max_count\n";
+      WriteText(pd, kSearchColumns, sizeof(kSearchColumns) - 1);
+      return;
+   }
+
+   WriteText(pd, "swept", 5);
+   for(int i = 0; i < g_param_count; i++)
+   {
+      WriteText(pd, ",", 1);
+      WriteText(pd, g_params[i].name, strlen(g_params[i].name));
+   }
+   static const char kColumns[] =
+      ",frames,fps,p50_ms,p95_ms,p99_ms,max_ms,ns_per_op\n";
+   WriteText(pd, kColumns, sizeof(kColumns) - 1);
+}
+
+// Write results for current setpoint.
+static void WriteResult(PlaydateAPI *pd, uint32_t elapsed)
+{
+   const BenchmarkParam *swept = g_params + g_index;
+   WriteText(pd, swept->name, strlen(swept->name));
+
+   char *text = NULL;
+   int length;
+   for(int i = 0; i < g_param_count; i++)
+   {
+      length = pd->system->formatString(&text, ",%d", *g_params[i].value);
+      WriteText(pd, text, length);
+      pd->system->realloc(text, 0);
+   }
+
+   FrameTimeStats stats;
+   GetFrameTimeStats(&stats);
+   const float seconds = CyclesToNanoseconds((float)elapsed) * 1e-9f;
+   length = pd->system->formatString(
+      &text, ",%d,%.2f,%.2f,%.2f,%.2f,%.2f,",
+      g_phase_frames, (double)(g_phase_frames / seconds),
+      (double)stats.p50, (double)stats.p95, (double)stats.p99,
+      (double)stats.max);
+   WriteText(pd, text, length);
+   pd->system->realloc(text, 0);
+
+   const BenchmarkParam *cost = GetCostParam();
+   if( cost->cycles_per_op != NULL && *cost->value > 0 )
+   {
+      length = pd->system->formatString(
+         &text, "%.3f",
+         (double)CyclesToNanoseconds(*cost->cycles_per_op));
+      WriteText(pd, text, length);
+      pd->system->realloc(text, 0);
+   }
+   WriteText(pd, "\n", 1);
+}
+
+// Write search result for current parameter.
+static void WriteSearchResult(PlaydateAPI *pd)
+{
+   char *text = NULL;
+   const int length = pd->system->formatString(
+      &text, "%s,%d,%d\n",
+      g_params[g_index].name, g_target_fps, g_results[g_index]);
+   WriteText(pd, text, length);
+   pd->system->logToConsole("search: %.*s", length - 1, text);
+   pd->system->realloc(text, 0);
+}
+
+// Start sweep or search.
+static void Start(PlaydateAPI *pd,
+                  const char *name,
+                  const BenchmarkParam *params,
+                  void (*reset)(void),
+                  int target_fps)
+{
+   StopSweep(pd);
+
+   // Refuse to run rather than silently skipping extra parameters.
+   int count = 0;
+   while( params[count].name != NULL )
+      count++;
+   if( count > MAX_PARAMS )
+   {
+      pd->system->logToConsole("%s: %s has %d parameters, limit is %d",
+                               target_fps > 0 ? "search" : "sweep",
+                               name, count, MAX_PARAMS);
+      return;
+   }
+
+   g_params = params;
+   g_param_count = count;
+   g_target_fps = target_fps;
+   for(int i = 0; i < g_param_count; i++)
+   {
+      g_saved_values[i] = *params[i].value;
+      g_results[i] = -1;
+   }
+
+   // Reset benchmark state with fixed random seed.  Parameter values
+   // are not part of the reset.
+   reset();
+   for(int i = 0; i < g_param_count; i++)
+      *params[i].value = g_saved_values[i];
+   srand(SWEEP_RANDOM_SEED);
+
+   g_index = 0;
+   if( FindParam() == 0 )
+   {
+      pd->system->logToConsole("%s: nothing to adjust for %s",
+                               target_fps > 0 ? "search" : "sweep", name);
+      return;
+   }
+
+   if( target_fps > 0 )
+   {
+      pd->system->formatString(
+         &g_filename, "search_%s_%dfps_%u.csv",
+         name, target_fps, pd->system->getSecondsSinceEpoch(NULL));
+   }
+   else
+   {
+      pd->system->formatString(&g_filename, "sweep_%s_%u.csv",
+                               name, pd->system->getSecondsSinceEpoch(NULL));
+   }
+   // Mode names may contain spaces, which are awkward in file names.
+   for(char *p = g_filename; *p != '\0'; p++)
+   {
+      if( *p == ' ' )
+         *p = '_';
+   }
+   g_file = pd->file->open(g_filename, kFileWrite);
+   if( g_file == NULL )
+   {
+      pd->system->logToConsole("can not open %s: %s",
+                               g_filename, pd->file->geterr());
+   }
+   WriteHeader(pd);
+
+   g_phase = kSweepWarmup;
+   g_phase_start = GetTimestamp(pd);
+   g_phase_frames = 0;
+}
+
+// Exported functions.
+void StartSweep(PlaydateAPI *pd,
+                const char *name,
+                const BenchmarkParam *params,
+                void (*reset)(void))
+{
+   Start(pd, name, params, reset, 0);
+}
+
+void StartSearch(PlaydateAPI *pd,
+                 const char *name,
+                 const BenchmarkParam *params,
+                 void (*reset)(void),
+                 int target_fps)
+{
+   Start(pd, name, params, reset, target_fps);
+}
+
+void StopSweep(PlaydateAPI *pd)
+{
+   g_show_results = 0;
+   if( g_file != NULL )
+   {
+      pd->file->close(g_file);
+      g_file = NULL;
+      pd->system->logToConsole("wrote %s", g_filename);
+   }
+   if( g_filename != NULL )
+   {
+      pd->system->realloc(g_filename, 0);
+      g_filename = NULL;
+   }
+   if( g_phase != kSweepIdle )
+   {
+      for(int i = 0; i < g_param_count; i++)
+         *g_params[i].value = g_saved_values[i];
+      g_phase = kSweepIdle;
+   }
+}
+
+int IsSweepActive(void)
+{
+   return g_phase != kSweepIdle;
+}
+
+int UpdateSweep(PlaydateAPI *pd)
+{
+   if( g_phase == kSweepIdle )
+      return 0;
+
+   const uint32_t elapsed = GetTimestamp(pd) - g_phase_start;
+   g_phase_frames++;
+   if( g_phase == kSweepWarmup )
+   {
+      if( elapsed >= WARMUP_CYCLES && g_phase_frames >= WARMUP_FRAMES )
+      {
+         g_phase = kSweepMeasure;
+         g_phase_start += elapsed;
+         g_phase_frames = 0;
+
+         // Discard measurements from earlier setpoints.
+         ResetFrameTime();
+         const BenchmarkParam *cost = GetCostParam();
+         if( cost->cycles_per_op != NULL )
+            *cost->cycles_per_op = 0;
+      }
+      return 0;
+   }
+
+   if( elapsed < (g_target_fps > 0 ? SEARCH_CYCLES : MEASURE_CYCLES) ||
+       g_phase_frames < MEASURE_FRAMES )
+   {
+      return 0;
+   }
+
+   // Move on to next setpoint.
+   const BenchmarkParam *p = g_params + g_index;
+   int next;
+   if( g_target_fps > 0 )
+   {
+      // Target is met if 95% of frames are within budget.
+      FrameTimeStats stats;
+      GetFrameTimeStats(&stats);
+      next = NextSearchValue(
+         p, *p->value, stats.p95 * g_target_fps <= 1000.0f);
+      if( next < 0 )
+      {
+         g_results[g_index] = g_pass;
+         WriteSearchResult(pd);
+      }
+   }
+   else
+   {
+      WriteResult(pd, elapsed);
+      next = NextValue(p, *p->value);
+   }
+
+   if( next >= 0 )
+   {
+      ApplyParams(next);
+   }
+   else
+   {
+      g_index++;
+      if( FindParam() == 0 )
+      {
+         StopSweep(pd);
+         g_show_results = g_target_fps > 0;
+         return 1;
+      }
+   }
+   g_phase = kSweepWarmup;
+   g_phase_start += elapsed;
+   g_phase_frames = 0;
+   return 1;
+}
+
+void DrawSweepStatus(PlaydateAPI *pd, int full_refresh)
+{
+   if( g_phase == kSweepIdle && g_show_results == 0 )
+      return;
+
+   char *text = NULL;
+   int length;
+   int y = STATUS_Y;
+   if( g_phase != kSweepIdle )
+   {
+      if( g_target_fps > 0 )
+      {
+         length = pd->system->formatString(
+            &text, "search %d fps: %s = %d (%d/%d)",
+            g_target_fps, g_params[g_index].name, *g_params[g_index].value,
+            g_index + 1, g_param_count);
+      }
+      else
+      {
+         length = pd->system->formatString(
+            &text, "sweep: %s = %d (%d/%d)",
+            g_params[g_index].name, *g_params[g_index].value,
+            g_index + 1, g_param_count);
+      }
+   }
+   else
+   {
+      // Show search results, two parameters per line.
+      int result_count = 0;
+      for(int i = 0; i < g_param_count; i++)
+         result_count += g_results[i] >= 0;
+      y = LCD_ROWS - 20 * (1 + (result_count + 1) / 2);
+
+      length = pd->system->formatString(
+         &text, "max count at %d fps:", g_target_fps);
+      int column = 0;
+      for(int i = 0; i < g_param_count; i++)
+      {
+         if( g_results[i] < 0 )
+            continue;
+         char *line = NULL;
+         const int line_length = pd->system->formatString(
+            &line, "%s%s%s = %d",
+            text, column == 0 ? "\n" : ", ",
+            g_params[i].name, g_results[i]);
+         pd->system->realloc(text, 0);
+         text = line;
+         length = line_length;
+         column = (column + 1) % 2;
+      }
+   }
+
+   pd->graphics->fillRect(0, y, LCD_COLUMNS, LCD_ROWS - y, kColorWhite);
+   pd->graphics->setDrawMode(kDrawModeCopy);
+   pd->graphics->drawText(text, length, kASCIIEncoding, 5, y);
+   pd->system->realloc(text, 0);
+
+   // Status only changes when parameters change, so the rows are only
+   // refreshed then, to avoid adding to the cost of measured frames.
+   if( full_refresh != 0 )
+      pd->graphics->markUpdatedRows(y, LCD_ROWS - 1);
+}
@@ -0,0 +1,47 @@
+// Automated parameter sweep.
+//
+// Steps each parameter of a benchmark through a range of values, holding
+// each value for a warm-up period and a measurement window, and writes
+// the measured frame rates to a CSV file in the data folder.
+//
+// Searches are similar, but instead of stepping through the full range,
+// each operation count is adjusted to find the largest count where frame
+// times still meet a target frame rate.
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include"pd_api.h"
+#include"param.h"
+
+// Start sweeping parameters.  "reset" is called at the start of the run
+// to reset benchmark state, so that runs are reproducible.
+void StartSweep(PlaydateAPI *pd,
+                const char *name,
+                const BenchmarkParam *params,
+                void (*reset)(void));
+
+// Start searching for the maximum count of each operation that sustains
+// "target_fps".  Results are written to a CSV file and shown at the
+// bottom of the screen until StopSweep is called.
+void StartSearch(PlaydateAPI *pd,
+                 const char *name,
+                 const BenchmarkParam *params,
+                 void (*reset)(void),
+                 int target_fps);
+
+// Stop sweep or search, clear search results, and restore parameters to
+// their values before the sweep.
+void StopSweep(PlaydateAPI *pd);
+
+// Returns nonzero if a sweep or search is in progress.
+int IsSweepActive(void);
+
+// Advance sweep state.  This should be called once per frame before
+// running the benchmark, and returns nonzero if parameters were changed.
+int UpdateSweep(PlaydateAPI *pd);
+
+// Draw sweep progress or search results at the bottom of the screen.
+void DrawSweepStatus(PlaydateAPI *pd, int full_refresh);
+
+#endif  // SWEEP_H_
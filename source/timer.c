@@ -0,0 +1,76 @@
+#include"timer.h"
+
+#if TARGET_PLAYDATE && USE_CYCLE_COUNTER
+
+// Cortex-M7 debug registers.
+#define DEMCR       (*(volatile uint32_t*)0xe000edfc)
+#define DWT_CTRL    (*(volatile uint32_t*)0xe0001000)
+#define DWT_CYCCNT  (*(volatile uint32_t*)0xe0001004)
+
+uint32_t GetTimestamp(PlaydateAPI *pd)
+{
+   static int initialized = 0;
+   if( initialized == 0 )
+   {
+      // Enable trace, then enable cycle counter.
+      DEMCR |= 1 << 24;
+      DWT_CYCCNT = 0;
+      DWT_CTRL |= 1;
+      initialized = 1;
+   }
+   return DWT_CYCCNT;
+}
+
+#else
+
+// Cycles accumulated up to the last time when elapsed time was reset.
+static uint32_t g_base = 0;
+
+uint32_t GetTimestamp(PlaydateAPI *pd)
+{
+   // Elapsed time is a float, which gets less precise as it grows, so we
+   // reset it every second and accumulate the time into an integer.
+   float elapsed = pd->system->getElapsedTime();
+   if( elapsed >= 1.0f )
+   {
+      // Intervals this long are not valid anyway, clamp to keep the
+      // conversion below in range.
+      if( elapsed > 16.0f )
+         elapsed = 16.0f;
+      g_base += (uint32_t)(elapsed * (CPU_CLOCK_MHZ * 1e6f));
+      pd->system->resetElapsedTime();
+      elapsed = 0;
+   }
+   return g_base + (uint32_t)(elapsed * (CPU_CLOCK_MHZ * 1e6f));
+}
+
+#endif
+
+void UpdateCost(float *cycles_per_op, uint32_t cycles, int op_count)
+{
+   if( op_count <= 0 )
+   {
+      *cycles_per_op = 0;
+      return;
+   }
+
+   // Smooth measurements over a few frames, otherwise the numbers are
+   // too jittery to read.
+   const float cost = (float)cycles / op_count;
+   if( *cycles_per_op <= 0 )
+      *cycles_per_op = cost;
+   else
+      *cycles_per_op = *cycles_per_op * 0.9f + cost * 0.1f;
+}
+
+void UpdateLoopCost(PlaydateAPI *pd, float *cycles_per_iteration, int count)
+{
+   const uint32_t t0 = GetTimestamp(pd);
+   for(int i = 0; i < count; i++)
+   {
+      // Empty asm statement to keep the compiler from removing the loop.
+      __asm__ volatile("");
+   }
+   const uint32_t t1 = GetTimestamp(pd);
+   UpdateCost(cycles_per_iteration, t1 - t0, count);
+}
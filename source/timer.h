@@ -0,0 +1,44 @@
+// Timer for measuring costs of individual benchmark kernels.
+//
+// Timestamps are in CPU cycles.  On the device, these can come from the
+// DWT cycle counter if built with USE_CYCLE_COUNTER=1, otherwise they are
+// derived from getElapsedTime.
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include<stdint.h>
+#include"pd_api.h"
+
+// CPU clock rate, for converting between time and cycles.
+#define CPU_CLOCK_MHZ   168
+
+// Return current timestamp in cycles.  Differences between two
+// timestamps are valid for intervals shorter than ~25 seconds.
+//
+// This owns getElapsedTime, nothing else should call resetElapsedTime.
+uint32_t GetTimestamp(PlaydateAPI *pd);
+
+// Update smoothed per-operation cost with the cycle count measured from
+// the current frame.
+void UpdateCost(float *cycles_per_op, uint32_t cycles, int op_count);
+
+// Update smoothed cost of each iteration of an empty loop, measured by
+// running "count" iterations.  This is the overhead from loop counters
+// and branches that is included in the cost of every benchmark loop.
+void UpdateLoopCost(PlaydateAPI *pd, float *cycles_per_iteration, int count);
+
+// Return per-operation cost with calibrated overhead subtracted, clamped
+// to zero since the two measurements are not perfectly additive.
+static inline float SubtractOverhead(float cycles, float overhead)
+{
+   return cycles > overhead ? cycles - overhead : 0;
+}
+
+// Convert cycles to nanoseconds.
+static inline float CyclesToNanoseconds(float cycles)
+{
+   return cycles * (1000.0f / CPU_CLOCK_MHZ);
+}
+
+#endif  // TIMER_H_